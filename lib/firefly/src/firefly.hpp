@@ -0,0 +1,28 @@
+#pragma once
+
+// Everything needed to put fireflies in a jar. None of this depends on the
+// Arduino; for that, also include <firefly/arduino.hpp> (or, on a computer,
+// <firefly/host.hpp>).
+#include <firefly/calibration.hpp>
+#include <firefly/clock.hpp>
+#include <firefly/color.hpp>
+#include <firefly/compositor.hpp>
+#include <firefly/events.hpp>
+#include <firefly/firefly.hpp>
+#include <firefly/jar.hpp>
+#include <firefly/noise.hpp>
+#include <firefly/output.hpp>
+#include <firefly/population.hpp>
+#include <firefly/predator.hpp>
+#include <firefly/profiler.hpp>
+#include <firefly/rng.hpp>
+#include <firefly/rolls.hpp>
+#include <firefly/scheduler.hpp>
+#include <firefly/sensors.hpp>
+#include <firefly/species.hpp>
+#include <firefly/spsc_queue.hpp>
+#include <firefly/swarm.hpp>
+#include <firefly/task.hpp>
+#include <firefly/telemetry.hpp>
+#include <firefly/ticker.hpp>
+#include <firefly/timeline.hpp>
@@ -0,0 +1,339 @@
+#pragma once
+
+// Glue between the engine and the Arduino side of things. This is the only
+// part of the library that knows about the Arduino, and it's header only so
+// that host builds never try to compile it.
+#ifdef ARDUINO
+
+#include <AceRoutine.h>
+#include <Adafruit_NeoPixel.h>
+#include <Arduino.h>
+#include <DallasTemperature.h>
+#include <ESP8266TrueRandom.h>
+#include <OneWire.h>
+
+#include <firefly/calibration.hpp>
+#include <firefly/clock.hpp>
+#include <firefly/output.hpp>
+#include <firefly/rng.hpp>
+#include <firefly/sensors.hpp>
+#include <firefly/task.hpp>
+#include <firefly/telemetry.hpp>
+#include <firefly/ticker.hpp>
+
+namespace firefly {
+namespace arduino {
+
+/*!
+    @brief  Clock backed by the Arduino micros().
+*/
+class MicrosClock : public Clock {
+  public:
+    uint32_t micros() override { return ::micros(); }
+};
+
+
+/*!
+    @brief  Randomness from the ESP8266's radio noise. This is slow,
+            so it's best kept behind a PooledRng.
+*/
+class TrueRandomRng : public Rng {
+  public:
+    uint32_t next() override {
+        uint32_t value;
+        ESP8266TrueRandom.memfill((char*)&value, sizeof(value));
+        return value;
+    }
+};
+
+
+/*!
+    @brief  Output to a strip driven by Adafruit_NeoPixel. The strip
+            is borrowed, not copied, so there's only ever one of it.
+
+            Given the strip's type (NEO_BGR and so on), colors skip
+            setPixelColor() and are packed straight into the strip's own
+            buffer, with a calibration too if there is one. The strip's
+            setBrightness() is then ignored; use the jar's instead.
+*/
+class NeoPixelSink : public OutputSink {
+  private:
+    Adafruit_NeoPixel& pixels;
+    Wire wire;
+    bool direct;
+
+  public:
+    /*!
+      @brief Go through setPixelColor(), for strips this can't pack for.
+    */
+    explicit NeoPixelSink(Adafruit_NeoPixel& pixels)
+        : pixels(pixels), wire{nullptr, 0, nullptr}, direct(false) {}
+
+    /*!
+      @param type  What the strip was made with. Only its channel order
+             matters, and only RGB strips (not RGBW) are packed for.
+      @param calibration  One per LED on the strip, or nullptr to leave
+             every LED as it is.
+    */
+    NeoPixelSink(Adafruit_NeoPixel& pixels, neoPixelType type, const LedCalibration* calibration = nullptr)
+        : pixels(pixels), wire{nullptr, (uint8_t)(type & 0x3F), calibration}, direct(true) {}
+
+    void set_pixel(uint16_t index, uint32_t rgb) override {
+        if (this->direct) {
+            this->get_wire()->pack(index, rgb);
+        } else {
+            this->pixels.setPixelColor(index, rgb);
+        }
+    }
+
+    void show() override { this->pixels.show(); }
+
+    const Wire* get_wire() override {
+        if (!this->direct) {
+            return nullptr;
+        }
+        // The strip can reallocate its buffer if its length changes.
+        this->wire.bytes = this->pixels.getPixels();
+        return &this->wire;
+    }
+};
+
+
+/*!
+    @brief  Telemetry out of the serial port, never waiting on it.
+*/
+class SerialSink : public TextSink {
+  public:
+    size_t write(const char* text, size_t length) override {
+        size_t room = Serial.availableForWrite();
+        return Serial.write(text, length < room ? length : room);
+    }
+};
+
+
+/*!
+    @brief  Runs every AceRoutine coroutine once, so that they can all
+            share one slot in the background tier.
+*/
+class AceRoutineTask : public Task {
+  public:
+    void run(uint32_t) override { ace_routine::CoroutineScheduler::loop(); }
+};
+
+
+
+/*!
+    @brief  A DS18B20 on a OneWire bus, read without ever holding up a
+            frame. DallasTemperature's own reads bit-bang the whole
+            exchange in one go (a getTempC() is a reset, nine bytes out
+            and nine back, around 13 ms), far longer than the slack
+            between two frames. So the sensor is only looked for once, in
+            begin(), and after that every exchange is taken a step at a
+            time: one bit (about 70 us) per poll(). The bus reset, which
+            holds the line low for 480 us, is split in two, the line left
+            low in between, since the DS18B20 doesn't mind a longer one.
+
+            Without a sensor on the bus, request() and poll() do nothing.
+*/
+class Ds18b20Sensor : public TemperatureSensor {
+  private:
+    // What the sensor is asked to do, in steps.
+    enum class Step : uint8_t {
+        idle,
+        reset,        // Line held low, waiting for 480 us to pass.
+        recover,      // Presence seen, waiting out the rest of the slot.
+        send,         // Shifting out the command bytes.
+        receive,      // Shifting in the scratchpad.
+        converting,   // Reading a bit until the conversion's done.
+    };
+
+    static constexpr uint8_t MATCH_ROM = 0x55;
+    static constexpr uint8_t CONVERT = 0x44;
+    static constexpr uint8_t READ_SCRATCHPAD = 0xBE;
+
+    uint8_t pin;
+    OneWire bus;
+    DallasTemperature sensors;
+    DeviceAddress address;
+    bool found;
+
+    Step step;
+    uint32_t since;
+    // Whether this exchange is the conversion or reading it back.
+    bool reading;
+    uint8_t command[10];
+    uint8_t scratchpad[9];
+    // How many bits of command have gone out, or scratchpad come in.
+    uint8_t bits;
+
+    void start(bool reading) {
+        this->reading = reading;
+        this->command[0] = MATCH_ROM;
+        memcpy(this->command + 1, this->address, sizeof(this->address));
+        this->command[9] = reading ? READ_SCRATCHPAD : CONVERT;
+        this->bits = 0;
+        digitalWrite(this->pin, LOW);
+        pinMode(this->pin, OUTPUT);
+        this->since = micros();
+        this->step = Step::reset;
+    }
+
+    /*!
+      @brief Take one step of the exchange.
+      @return true once the scratchpad has been read back.
+    */
+    bool advance() {
+        switch (this->step) {
+        case Step::idle:
+            return false;
+
+        case Step::reset:
+            if (micros() - this->since < 480) {
+                return false;
+            }
+            // Let go, and see whether anyone pulls the line low again.
+            pinMode(this->pin, INPUT);
+            delayMicroseconds(70);
+            if (digitalRead(this->pin)) {
+                this->step = Step::idle;
+                return false;
+            }
+            this->since = micros();
+            this->step = Step::recover;
+            return false;
+
+        case Step::recover:
+            if (micros() - this->since >= 410) {
+                this->step = Step::send;
+            }
+            return false;
+
+        case Step::send:
+            this->bus.write_bit(this->command[this->bits / 8] >> this->bits % 8 & 1);
+            if (++this->bits == 8 * sizeof(this->command)) {
+                this->bits = 0;
+                this->step = this->reading ? Step::receive : Step::converting;
+            }
+            return false;
+
+        case Step::receive:
+            if (this->bits % 8 == 0) {
+                this->scratchpad[this->bits / 8] = 0;
+            }
+            this->scratchpad[this->bits / 8] |= this->bus.read_bit() << this->bits % 8;
+            if (++this->bits < 8 * sizeof(this->scratchpad)) {
+                return false;
+            }
+            this->step = Step::idle;
+            return true;
+
+        case Step::converting:
+            // The DS18B20 reads 0 until the conversion's done.
+            if (this->bus.read_bit()) {
+                this->start(true);
+            }
+            return false;
+        }
+        return false;
+    }
+
+  public:
+    explicit Ds18b20Sensor(uint8_t pin)
+        : pin(pin), bus(pin), sensors(&bus), found(false), step(Step::idle), since(0), reading(false), bits(0) {}
+
+    /*!
+      @brief Look for the sensor. This does block, for a search of the
+             bus, so call it from setup().
+    */
+    void begin() {
+        this->sensors.begin();
+        this->found = this->sensors.getAddress(this->address, 0);
+    }
+
+    void request() override {
+        if (this->found) {
+            this->start(false);
+        }
+    }
+
+    bool poll(int16_t& decicelsius) override {
+        if (!this->advance()) {
+            return false;
+        }
+        if (OneWire::crc8(this->scratchpad, 8) != this->scratchpad[8]) {
+            return false;
+        }
+        // Sixteenths of a degree, at the power-on 12 bit resolution.
+        int16_t raw = this->scratchpad[1] << 8 | this->scratchpad[0];
+        decicelsius = (int32_t)raw * 10 / 16;
+        return true;
+    }
+};
+
+
+/*!
+    @brief  An analog thermometer like the TMP36 on A0. The ESP8266 only
+            has the one ADC, so this can't be used alongside anything
+            else on A0. On a NodeMCU, A0 reads 0-1023 for 0-3.3 V.
+*/
+class AnalogTemperatureSensor : public TemperatureSensor {
+  private:
+    // Tenths of a degree at 0 V, and tenths of a degree per volt.
+    int16_t offset;
+    int16_t per_volt;
+    bool pending;
+
+  public:
+    // The defaults are for a TMP36: 10 mV per degree, 0.5 V at 0 C.
+    explicit AnalogTemperatureSensor(int16_t offset = -500, int16_t per_volt = 1000)
+        : offset(offset), per_volt(per_volt), pending(false) {}
+
+    void request() override { this->pending = true; }
+
+    bool poll(int16_t& decicelsius) override {
+        if (!this->pending) {
+            return false;
+        }
+        this->pending = false;
+        int32_t millivolts = analogRead(A0) * 3300L / 1023;
+        decicelsius = this->offset + millivolts * this->per_volt / 1000;
+        return true;
+    }
+};
+
+
+/*!
+    @brief  A photoresistor on A0, in a divider with a fixed resistor so
+            the voltage goes up as it gets lighter. Like the analog
+            thermometer, it needs A0 to itself. A read takes the ADC
+            around 100 us, which is why LightTask only does one now and
+            then.
+*/
+class PhotoresistorSensor : public LightSensor {
+  public:
+    uint16_t read() override { return analogRead(A0); }
+};
+
+
+// The ticker timer1 is currently posting to.
+inline FrameTicker* timer1_ticker = nullptr;
+
+IRAM_ATTR inline void timer1_tick() {
+    timer1_ticker->tick(::micros());
+}
+
+/*!
+    @brief  Have timer1 post a tick to the ticker every period. timer1
+            counts at 80 MHz / 16, so 5 counts to the microsecond.
+*/
+inline void start_timer1(FrameTicker& ticker) {
+    timer1_ticker = &ticker;
+    timer1_attachInterrupt(timer1_tick);
+    timer1_enable(TIM_DIV16, TIM_EDGE, TIM_LOOP);
+    timer1_write(ticker.get_period() * 5);
+}
+
+}
+}
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/config.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  The order an LED wants its channels in on the wire. These are
+            encoded the same way as Adafruit_NeoPixel's NEO_RGB and
+            friends: two bits each for where red, green and blue go, in
+            that order from the top.
+*/
+namespace order {
+
+inline constexpr uint8_t rgb = (0 << 4) | (1 << 2) | 2;
+inline constexpr uint8_t rbg = (0 << 4) | (2 << 2) | 1;
+inline constexpr uint8_t grb = (1 << 4) | (0 << 2) | 2;
+inline constexpr uint8_t gbr = (2 << 4) | (0 << 2) | 1;
+inline constexpr uint8_t brg = (1 << 4) | (2 << 2) | 0;
+inline constexpr uint8_t bgr = (2 << 4) | (1 << 2) | 0;
+
+}
+
+
+/*!
+    @brief  How to correct one LED. Cheap fairy lights vary a fair bit
+            from one LED to the next, in how bright they are and what
+            tint they give white, and now and then one turns up with its
+            channels in a different order. Each channel gets a gain,
+            255 for as is, and the LED its own order.
+*/
+struct LedCalibration {
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+    uint8_t order;
+};
+
+
+/*!
+  @brief Turn a color into the three bytes an LED is sent, corrected
+         for that LED, all in the one step.
+  @param rgb  Color packed as 0x00RRGGBB.
+  @param led  How to correct it.
+  @param wire  Where the LED's three bytes go.
+*/
+FIREFLY_HOT inline void pack(uint32_t rgb, const LedCalibration& led, uint8_t* wire) {
+    wire[(led.order >> 4) & 3] = (((rgb >> 16) & 0xFF) * (led.red + 1)) >> 8;
+    wire[(led.order >> 2) & 3] = (((rgb >> 8) & 0xFF) * (led.green + 1)) >> 8;
+    wire[led.order & 3] = ((rgb & 0xFF) * (led.blue + 1)) >> 8;
+}
+
+
+/*!
+  @brief Turn a color into the three bytes an LED is sent, as it is.
+  @param rgb  Color packed as 0x00RRGGBB.
+  @param order  The LED's channel order.
+  @param wire  Where the LED's three bytes go.
+*/
+FIREFLY_HOT inline void pack(uint32_t rgb, uint8_t order, uint8_t* wire) {
+    wire[(order >> 4) & 3] = rgb >> 16;
+    wire[(order >> 2) & 3] = rgb >> 8;
+    wire[order & 3] = rgb;
+}
+
+
+/*!
+    @brief  The bytes that go out to a strip, three per LED in the order
+            they're sent, and how to pack each LED's color into them:
+            with its calibration if there is one, or else all in the
+            strip's one order.
+*/
+struct Wire {
+    uint8_t* bytes;
+    uint8_t order;
+    const LedCalibration* calibration;
+
+    FIREFLY_HOT void pack(size_t index, uint32_t rgb) const {
+        if (this->calibration) {
+            firefly::pack(rgb, this->calibration[index], this->bytes + 3 * index);
+        } else {
+            firefly::pack(rgb, this->order, this->bytes + 3 * index);
+        }
+    }
+};
+
+
+/*!
+  @brief A strip's worth of LEDs all left as they are, to start from
+         and then correct the odd ones out.
+  @tparam N  Number of LEDs.
+  @param order  The strip's channel order.
+*/
+template <size_t N>
+constexpr std::array<LedCalibration, N> uncalibrated(uint8_t order) {
+    std::array<LedCalibration, N> leds = {};
+    for (size_t i = 0; i < N; i++) {
+        leds[i] = {255, 255, 255, order};
+    }
+    return leds;
+}
+
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/config.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  Source of time for the engine. On the ESP8266 this is
+            micros(), on the host it's whatever the simulator says
+            it is.
+
+            micros() is the raw 32 bit counter, which wraps around
+            about every 71 minutes, so always compare its values by
+            subtracting. now() stretches it to 64 bits, which won't
+            wrap for half a million years, by noticing each time it
+            goes backwards. That only works if now() is called at
+            least once per wrap, which the main loop does thousands
+            of times a second, and only from one place at a time, so
+            never from an interrupt.
+*/
+class Clock {
+  private:
+    uint32_t last;
+    uint32_t wraps;
+
+  public:
+    Clock() : last(0), wraps(0) {}
+    virtual ~Clock() = default;
+
+    /*!
+      @brief  The current time, as the raw 32 bit counter.
+      @return Microseconds since some arbitrary starting point, modulo 2^32.
+    */
+    virtual uint32_t micros() = 0;
+
+    /*!
+      @brief  The current time, without wrapping around.
+      @return Microseconds since the same starting point as micros(),
+              counting every wrap of micros() since the first call.
+    */
+    FIREFLY_HOT uint64_t now() {
+        uint32_t raw = this->micros();
+        if (raw < this->last) {
+            this->wraps++;
+        }
+        this->last = raw;
+        return ((uint64_t)this->wraps << 32) | raw;
+    }
+};
+
+
+/*!
+    @brief  A clock that only moves when told to. Used by the simulator
+            so that a whole night can be run in a fraction of a second.
+*/
+class ManualClock : public Clock {
+  private:
+    uint32_t raw;
+
+  public:
+    explicit ManualClock(uint32_t start = 0) : raw(start) {}
+
+    uint32_t micros() override { return this->raw; }
+
+    void set(uint32_t micros) { this->raw = micros; }
+    void advance(uint32_t micros) { this->raw += micros; }
+};
+
+}
@@ -0,0 +1,18 @@
+#include <firefly/color.hpp>
+
+namespace firefly {
+
+uint32_t compute_rgb(uint8_t brightness, float r_mult, float g_mult, float b_mult) {
+    int r = brightness * r_mult;
+    int g = brightness * g_mult;
+    int b = brightness * b_mult;
+    return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+
+uint32_t p_pyralis_brightness(uint8_t brightness) {
+    // Corresponds to approx 562 nm, rgb(201, 255, 0)
+    return emission<562>[brightness];
+}
+
+}
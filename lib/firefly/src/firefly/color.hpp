@@ -0,0 +1,215 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace firefly {
+
+/*!
+  @brief  Convert Red Green and Blue values based on a single
+          brightness value. This allows us to use a single value
+          to compute brightness of all LEDs maintaining the same
+          color. The multipliers are all values from 0 - 1 which
+          correspond to a color. They can be found by finding the
+          RGB values of a color, and dividing each value by 255.
+  @param  brightness  The brightness value from 0 to 255.
+  @param  r_mult  The red channel multiplier.
+  @param  g_mult  The green channel multiplier.
+  @param  b_mult  The blue channel multiplier.
+  @return uint32_t color value packed as 0x00RRGGBB, compatible
+          with Adafruit_NeoPixel.setPixelColor().
+*/
+uint32_t compute_rgb(uint8_t brightness, float r_mult, float g_mult, float b_mult);
+
+
+/*!
+  @brief  Find the correct RGB value given the brightness
+          corresponding to the peak emission spectrum of
+          562 nm. This is meant to closely match the color
+          of Photinus Pyralis, the Common Eastern Firefly.
+  @param  brightness  The brightness value from 0 to 255.
+  @return uint32_t color value packed as 0x00RRGGBB.
+*/
+uint32_t p_pyralis_brightness(uint8_t brightness);
+
+
+namespace spectrum {
+
+// Just enough maths to work colors out at compile time, where <math.h>
+// isn't allowed. Only ever used there, so none of it needs to be fast.
+
+constexpr double LN2 = 0.69314718055994530942;
+
+/*!
+  @brief e to the x, by halving x until the series converges quickly
+         and squaring back up.
+*/
+constexpr double exp(double x) {
+    int halvings = 0;
+    while (x > 0.5 || x < -0.5) {
+        x /= 2;
+        halvings++;
+    }
+    double sum = 1, term = 1;
+    for (int n = 1; n < 20; n++) {
+        term *= x / n;
+        sum += term;
+    }
+    for (int i = 0; i < halvings; i++) {
+        sum *= sum;
+    }
+    return sum;
+}
+
+/*!
+  @brief Natural log of x > 0: bring x into [0.5, 1) with powers of
+         two, then the atanh series.
+*/
+constexpr double log(double x) {
+    int twos = 0;
+    while (x >= 1) {
+        x /= 2;
+        twos++;
+    }
+    while (x < 0.5) {
+        x *= 2;
+        twos--;
+    }
+    double y = (x - 1) / (x + 1);
+    double sum = 0, term = y;
+    for (int n = 1; n < 60; n += 2) {
+        sum += term / n;
+        term *= y * y;
+    }
+    return 2 * sum + twos * LN2;
+}
+
+constexpr double pow(double x, double y) { return x > 0 ? exp(y * log(x)) : 0; }
+
+
+/*!
+    @brief  A color, each channel from 0 to 1.
+*/
+struct Rgb {
+    double r;
+    double g;
+    double b;
+};
+
+// How the LEDs respond: the channels go through this power before use,
+// which lifts the in-between colors (yellows and cyans) towards what
+// the eye sees in the real thing.
+constexpr double GAMMA = 0.8;
+
+/*!
+  @brief The color of light of a single wavelength, after Dan Bruton's
+         well known approximation: straight lines between the pure
+         colors of the spectrum, dimming off at either end where the
+         eye stops seeing it.
+  @param nm  Wavelength in nanometers. Outside 380 to 780, black.
+*/
+constexpr Rgb wavelength(double nm) {
+    Rgb rgb = {0, 0, 0};
+    if (nm >= 380 && nm < 440) {
+        rgb = {(440 - nm) / (440 - 380), 0, 1};
+    } else if (nm >= 440 && nm < 490) {
+        rgb = {0, (nm - 440) / (490 - 440), 1};
+    } else if (nm >= 490 && nm < 510) {
+        rgb = {0, 1, (510 - nm) / (510 - 490)};
+    } else if (nm >= 510 && nm < 580) {
+        rgb = {(nm - 510) / (580 - 510), 1, 0};
+    } else if (nm >= 580 && nm < 645) {
+        rgb = {1, (645 - nm) / (645 - 580), 0};
+    } else if (nm >= 645 && nm <= 780) {
+        rgb = {1, 0, 0};
+    }
+
+    double edge = 1;
+    if (nm >= 380 && nm < 420) {
+        edge = 0.3 + 0.7 * (nm - 380) / (420 - 380);
+    } else if (nm > 700 && nm <= 780) {
+        edge = 0.3 + 0.7 * (780 - nm) / (780 - 700);
+    }
+    return {pow(rgb.r * edge, GAMMA), pow(rgb.g * edge, GAMMA), pow(rgb.b * edge, GAMMA)};
+}
+
+/*!
+  @brief The color of a spread of wavelengths: a bell curve around a
+         peak, added up a nanometer at a time, then scaled so the
+         brightest channel is 1. Firefly light isn't one wavelength,
+         it's a hump some 60 nm wide.
+  @param peak_nm  Where the curve peaks.
+  @param width_nm  Its standard deviation. 0 for just the peak.
+*/
+constexpr Rgb emission(uint16_t peak_nm, uint16_t width_nm) {
+    if (width_nm == 0) {
+        return wavelength(peak_nm);
+    }
+    Rgb sum = {0, 0, 0};
+    for (int nm = peak_nm - 3 * width_nm; nm <= peak_nm + 3 * width_nm; nm++) {
+        double d = (double)(nm - peak_nm) / width_nm;
+        double weight = exp(-d * d / 2);
+        Rgb rgb = wavelength(nm);
+        sum.r += rgb.r * weight;
+        sum.g += rgb.g * weight;
+        sum.b += rgb.b * weight;
+    }
+    double top = sum.r > sum.g ? sum.r : sum.g;
+    top = top > sum.b ? top : sum.b;
+    return top > 0 ? Rgb{sum.r / top, sum.g / top, sum.b / top} : sum;
+}
+
+}
+
+
+/*!
+    @brief  Every color an LED can show for one kind of light, from off
+            to full brightness, worked out ahead of time so looking one
+            up is all there is to it. Each entry is the same as
+            compute_rgb() gives for the light's channel multipliers.
+
+            A table is 1 KB, and on the ESP8266 it sits in RAM like any
+            other constant, where every LED of every frame can read it
+            without waiting on flash. Jar and Swarm count their species'
+            table against FIREFLY_RAM_BUDGET.
+*/
+struct ColorTable {
+    uint32_t rgb[256];
+
+    static constexpr ColorTable of(spectrum::Rgb color) {
+        ColorTable table = {};
+        for (size_t i = 0; i < 256; i++) {
+            uint32_t r = i * color.r;
+            uint32_t g = i * color.g;
+            uint32_t b = i * color.b;
+            table.rgb[i] = r << 16 | g << 8 | b;
+        }
+        return table;
+    }
+
+    constexpr uint32_t operator[](uint8_t brightness) const { return this->rgb[brightness]; }
+};
+
+/*!
+    @brief  The color table for light peaking at NM nanometers, WIDTH
+            wide (see spectrum::emission()). There's only ever one of
+            each, however many species share it, and only if something
+            uses it.
+*/
+template <uint16_t NM, uint16_t WIDTH = 0>
+inline constexpr ColorTable emission = ColorTable::of(spectrum::emission(NM, WIDTH));
+
+
+// Known colors of the spectrum, and the one P. Pyralis has always been
+// given, so that nothing above quietly drifts.
+static_assert(emission<440>[255] == 0x0000FF, "440 nm should be blue");
+static_assert(emission<490>[255] == 0x00FFFF, "490 nm should be cyan");
+static_assert(emission<510>[255] == 0x00FF00, "510 nm should be green");
+static_assert(emission<580>[255] == 0xFFFF00, "580 nm should be yellow");
+static_assert(emission<645>[255] == 0xFF0000, "645 nm should be red");
+static_assert(emission<562>[255] == 0xC9FF00, "562 nm should be rgb(201, 255, 0)");
+static_assert(emission<562>[128] == 0x648000, "Half brightness should be half of each channel");
+static_assert(emission<562>[0] == 0, "Zero brightness should be off");
+static_assert(emission<400>[255] == 0x8200B4, "400 nm should be a dim violet");
+
+}
@@ -0,0 +1,259 @@
+#pragma once
+
+#include <array>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/config.hpp>
+#include <firefly/output.hpp>
+#include <firefly/species.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  Turns firefly brightness into LED colors. Everything that
+            applies to the picture as a whole, rather than to any one
+            firefly, happens here: the global brightness scale (to follow
+            the room's light), and optionally an afterglow, where LEDs
+            fade out over a few tens of milliseconds rather than cutting
+            off. Pixels only go out to the sink when their color
+            actually changes, and the sink is only shown when something
+            did. If the sink keeps the strip's bytes itself, changed
+            pixels are packed straight into them, so going from a
+            firefly's brightness to the bytes on the wire is one step.
+    @tparam N  Number of LEDs.
+*/
+template <size_t N>
+class Compositor {
+  private:
+    OutputSink& sink;
+    const Wire* wire;
+
+    // The color of every LED, as last sent to the sink.
+    std::array<uint32_t, N> frame;
+    bool dirty;
+
+    // Global brightness, 255 for full.
+    uint8_t brightness;
+
+    // With an afterglow, what the fireflies want each LED to be, which
+    // the frame then follows up straight away but down only slowly.
+    std::array<uint32_t, N> target;
+    bool afterglow;
+    uint64_t last_show;
+
+    // How much of an LED's light is left after 256 * i microseconds,
+    // out of 256. Gaps longer than the table decay like the last entry.
+    static constexpr size_t DECAY_STEPS = 64;
+    std::array<uint8_t, DECAY_STEPS> decay;
+
+    /*!
+      @brief Every channel of a pixel times factor / 256, all three at
+             once: red and blue share one multiply, and green has the
+             other to itself, each with a byte of headroom so nothing
+             spills into the next channel.
+    */
+    static uint32_t scale(uint32_t rgb, uint32_t factor) {
+        uint32_t red_blue = ((rgb & 0x00FF00FF) * factor >> 8) & 0x00FF00FF;
+        uint32_t green = ((rgb & 0x0000FF00) * factor >> 8) & 0x0000FF00;
+        return red_blue | green;
+    }
+
+    /*!
+      @brief Each channel of the larger of two pixels. A channel of `a`
+             with 256 added still has that bit set after taking away the
+             same channel of `b` exactly when it's at least as big, which
+             gives a mask to pick with.
+    */
+    static uint32_t brightest(uint32_t a, uint32_t b) {
+        uint32_t red_blue = ((a & 0x00FF00FF) | 0x01000100) - (b & 0x00FF00FF);
+        uint32_t green = (((a >> 8) & 0x000000FF) | 0x00000100) - ((b >> 8) & 0x000000FF);
+        uint32_t keep = ((red_blue >> 8) & 0x00010001) | (((green >> 8) & 0x00000001) << 8);
+        uint32_t mask = keep * 0xFF;
+        return (a & mask) | (b & ~mask);
+    }
+
+    /*!
+      @brief Hand an LED's new color to the sink, packed straight into
+             its bytes if it has some.
+    */
+    FIREFLY_HOT void send(size_t index, uint32_t rgb) {
+        if (this->wire) {
+            this->wire->pack(index, rgb);
+        } else {
+            this->sink.set_pixel(index, rgb);
+        }
+        this->dirty = true;
+    }
+
+  public:
+    explicit Compositor(OutputSink& sink)
+        : sink(sink), wire(sink.get_wire()), dirty(false), brightness(255), afterglow(false), last_show(0) {}
+
+    /*!
+      @brief Turn every LED off.
+    */
+    void clear() {
+        this->wire = this->sink.get_wire();
+        for (size_t i = 0; i < N; i++) {
+            this->frame[i] = 0;
+            this->target[i] = 0;
+            this->send(i, 0);
+        }
+    }
+
+    /*!
+      @brief Light an LED with a firefly.
+      @param index  Which LED.
+      @param species  Whose color to use.
+      @param level  The firefly's brightness, 0 to 255.
+    */
+    FIREFLY_HOT void put(size_t index, const Species& species, uint8_t level) {
+        uint8_t scaled = (level * (this->brightness + 1)) >> 8;
+        uint32_t rgb = species.color(scaled);
+        if (this->afterglow) {
+            this->target[index] = rgb;
+        } else if (rgb != this->frame[index]) {
+            this->frame[index] = rgb;
+            this->send(index, rgb);
+        }
+    }
+
+    /*!
+      @brief Fade the whole frame towards what's been put, then send it
+             out if anything changed. Without an afterglow, this is
+             just show().
+      @param now  From Clock::now(), to know how much to fade by.
+    */
+    FIREFLY_HOT_LOOP void show(uint64_t now) {
+        if (this->afterglow) {
+            uint64_t elapsed = (now - this->last_show) >> 8;
+            uint32_t factor = this->decay[elapsed < DECAY_STEPS ? elapsed : DECAY_STEPS - 1];
+            for (size_t i = 0; i < N; i++) {
+                uint32_t rgb = brightest(this->target[i], scale(this->frame[i], factor));
+                if (rgb != this->frame[i]) {
+                    this->frame[i] = rgb;
+                    this->send(i, rgb);
+                }
+            }
+        }
+        this->last_show = now;
+        this->show();
+    }
+
+    /*!
+      @brief Send the frame out, if anything changed.
+    */
+    void show() {
+        if (this->dirty) {
+            this->sink.show();
+            this->dirty = false;
+        }
+    }
+
+    /*!
+      @brief Change the global brightness. This only affects pixels as
+             they're next put, so whoever calls this should put every lit
+             pixel again.
+      @param brightness  255 for full, 0 for off.
+    */
+    void set_brightness(uint8_t brightness) { this->brightness = brightness; }
+    uint8_t get_brightness() const { return this->brightness; }
+
+    /*!
+      @brief Have LEDs fade out rather than cut off: each frame, every
+             LED shows whichever is brighter of what it's been put to and
+             what it showed last, faded a bit. Set up once here, so each
+             frame is a multiply and a compare per LED.
+      @param time_constant_ms  How long it takes an LED to fade to about
+             a third, in milliseconds. 0 turns the afterglow off.
+    */
+    void set_afterglow(uint16_t time_constant_ms) {
+        if (time_constant_ms && !this->afterglow) {
+            this->target = this->frame;
+        }
+        this->afterglow = time_constant_ms != 0;
+        for (size_t i = 0; i < DECAY_STEPS; i++) {
+            float left = time_constant_ms ? expf(-(i * 256.0f) / (time_constant_ms * 1000.0f)) : 0;
+            this->decay[i] = left * 256 > 255 ? 255 : left * 256;
+        }
+    }
+
+    const std::array<uint32_t, N>& get_frame() const { return this->frame; }
+};
+
+
+/*!
+    @brief  Somewhere to add up light that doesn't sit on exactly one
+            LED, like a firefly that's moving. Each bit of light is split
+            between the two LEDs either side of where it is, in
+            proportion to how close it is to each, so something gliding
+            along the strip fades smoothly from one LED to the next
+            instead of hopping. Overlapping light adds up, as far as
+            full brightness.
+
+            Once everything for a frame has been added, draw() hands
+            every LED whose level changed to a Compositor.
+    @tparam N  Number of LEDs.
+*/
+template <size_t N>
+class Canvas {
+  private:
+    // This frame's light, never more than 255 however much is added,
+    // and what was drawn last frame.
+    std::array<uint16_t, N> glow;
+    std::array<uint8_t, N> drawn;
+    bool stale;
+
+    static uint16_t saturate(uint32_t level) { return level > 255 ? 255 : level; }
+
+  public:
+    Canvas() : stale(true) {
+        this->glow.fill(0);
+        this->drawn.fill(0);
+    }
+
+    /*!
+      @brief Add some light.
+      @param position  Where, in 1/256ths of an LED. 0 is the middle of
+             the first LED, and (N - 1) * 256 the middle of the last.
+      @param level  How bright, 0 to 255.
+    */
+    void add(uint32_t position, uint8_t level) {
+        size_t index = position >> 8;
+        uint32_t next = position & 0xFF;
+        if (index >= N) {
+            return;
+        }
+        this->glow[index] = saturate(this->glow[index] + ((level * (256 - next)) >> 8));
+        if (next && index + 1 < N) {
+            this->glow[index + 1] = saturate(this->glow[index + 1] + ((level * next) >> 8));
+        }
+    }
+
+    /*!
+      @brief Put the frame's light into a compositor, and start the next
+             frame empty. Only LEDs whose level changed are put, unless
+             invalidate() was called.
+    */
+    void draw(Compositor<N>& compositor, const Species& species) {
+        for (size_t i = 0; i < N; i++) {
+            uint8_t level = this->glow[i];
+            if (level != this->drawn[i] || this->stale) {
+                this->drawn[i] = level;
+                compositor.put(i, species, level);
+            }
+            this->glow[i] = 0;
+        }
+        this->stale = false;
+    }
+
+    /*!
+      @brief Have the next draw() put every LED, for after something
+             about the compositor (its brightness, say) changed.
+    */
+    void invalidate() { this->stale = true; }
+};
+
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+// Compile time limits the jar checks itself against. All of them can be
+// overridden with build flags, e.g. -DFIREFLY_RAM_BUDGET=32768.
+
+// How many bytes of RAM a jar (fireflies plus frame buffer plus the
+// strip's own buffer plus its species' color table) may take up. The
+// ESP8266 has around 40 KB free once the core and WiFi stack have had
+// their share.
+#ifndef FIREFLY_RAM_BUDGET
+#define FIREFLY_RAM_BUDGET 16384
+#endif
+
+// How long it takes to push one WS2812B's 24 bits out at 800 kHz,
+// and how long the strip needs to latch afterwards, in microseconds.
+#ifndef FIREFLY_WIRE_US_PER_LED
+#define FIREFLY_WIRE_US_PER_LED 30
+#endif
+
+#ifndef FIREFLY_WIRE_LATCH_US
+#define FIREFLY_WIRE_LATCH_US 300
+#endif
+
+// How long a frame may take to go out, in microseconds. If this is left
+// at 0, a jar uses its species' shortest brightness step, since a frame
+// that takes longer than that means steps get dropped.
+#ifndef FIREFLY_FRAME_BUDGET_US
+#define FIREFLY_FRAME_BUDGET_US 0
+#endif
+
+// How often the jar renders a frame when it's run by a Scheduler, in
+// microseconds. Brightness steps are around a millisecond apart, so
+// rendering any more often than that would just find nothing changed.
+#ifndef FIREFLY_FRAME_PERIOD_US
+#define FIREFLY_FRAME_PERIOD_US 1000
+#endif
+
+// Most fireflies a jar rolls new timings for in one go (see Rolls). If
+// more flashes than this end in one frame, it rolls in several goes.
+// Each one waiting takes up about 50 bytes.
+#ifndef FIREFLY_ROLL_BATCH
+#define FIREFLY_ROLL_BATCH 32
+#endif
+
+// How many bytes a Jar::Checkpoint may take up, so it can be kept
+// through deep sleep. The ESP8266 has 512 bytes of RTC memory for user
+// data, and nothing else survives.
+#ifndef FIREFLY_RTC_BYTES
+#define FIREFLY_RTC_BYTES 512
+#endif
+
+// Functions that run inside an interrupt handler. On the ESP8266 these
+// have to live in IRAM, since flash may not be readable mid-interrupt.
+#if defined(ESP8266)
+#include <c_types.h>
+#define FIREFLY_ISR IRAM_ATTR
+#else
+#define FIREFLY_ISR
+#endif
+
+// Functions that an interrupt handler calls, but that aren't only for
+// interrupt handlers. Rather than put every copy in IRAM, they're always
+// inlined, so the handler gets a copy in IRAM and everyone else one in
+// flash.
+#define FIREFLY_INLINE inline __attribute__((always_inline))
+
+// Functions that run every frame. Code on the ESP8266 normally runs
+// out of flash through a 32 KB cache, and everything else in the loop
+// (WiFi, serial) competes for it, so a frame can start with its code
+// evicted. Build with -DFIREFLY_HOT_IRAM=1 to keep these in IRAM
+// instead, if there's room: scripts/iram_report.py says how much is
+// left after each build.
+//
+// FIREFLY_HOT is for the small functions every firefly goes through
+// (a few hundred bytes all told). FIREFLY_HOT_LOOP is for the loops
+// around them, Jar::update() and the like, which are a kilobyte or two
+// each and, being templates, one copy per size of jar: those only go
+// in IRAM with -DFIREFLY_HOT_IRAM=2, for when the report shows room.
+#ifndef FIREFLY_HOT_IRAM
+#define FIREFLY_HOT_IRAM 0
+#endif
+
+#if defined(ESP8266) && FIREFLY_HOT_IRAM
+#define FIREFLY_HOT IRAM_ATTR
+#else
+#define FIREFLY_HOT
+#endif
+
+#if defined(ESP8266) && FIREFLY_HOT_IRAM >= 2
+#define FIREFLY_HOT_LOOP IRAM_ATTR
+#else
+#define FIREFLY_HOT_LOOP
+#endif
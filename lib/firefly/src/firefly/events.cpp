@@ -0,0 +1,59 @@
+#include <firefly/events.hpp>
+
+namespace firefly {
+
+EventBus::EventBus(Clock& clock, uint8_t batch) : clock(clock), count(0), batch(batch) {
+    this->reset();
+}
+
+
+bool EventBus::subscribe(Listener& listener) {
+    if (this->count == FIREFLY_MAX_LISTENERS) {
+        return false;
+    }
+    this->listeners[this->count++] = &listener;
+    return true;
+}
+
+
+bool EventBus::publish(const FlashEvent& event) {
+    if (!this->queue.push(event)) {
+        this->dropped++;
+        return false;
+    }
+    this->published++;
+    return true;
+}
+
+
+size_t EventBus::dispatch(uint64_t now) {
+    FlashEvent event;
+    size_t delivered = 0;
+
+    while (delivered < this->batch && this->queue.pop(event)) {
+        for (uint8_t i = 0; i < this->count; i++) {
+            this->listeners[i]->on_flash(event, now);
+        }
+        uint64_t latency = now - event.time;
+        uint32_t clamped = latency > UINT32_MAX ? UINT32_MAX : latency;
+        if (clamped > this->latency_max) {
+            this->latency_max = clamped;
+        }
+        this->latency_total += latency;
+        delivered++;
+    }
+
+    this->delivered += delivered;
+    return delivered;
+}
+
+
+void EventBus::reset() {
+    this->published = 0;
+    this->dropped = 0;
+    this->delivered = 0;
+    this->latency_max = 0;
+    this->latency_total = 0;
+}
+
+}
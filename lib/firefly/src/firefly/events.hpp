@@ -0,0 +1,108 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/clock.hpp>
+#include <firefly/spsc_queue.hpp>
+#include <firefly/task.hpp>
+
+// How many flash events can be waiting to be delivered. Must be a power
+// of two.
+#ifndef FIREFLY_EVENT_QUEUE
+#define FIREFLY_EVENT_QUEUE 32
+#endif
+
+// How many things can listen for flash events.
+#ifndef FIREFLY_MAX_LISTENERS
+#define FIREFLY_MAX_LISTENERS 4
+#endif
+
+namespace firefly {
+
+/*!
+    @brief  A firefly started a flash.
+*/
+struct FlashEvent {
+    uint16_t firefly;
+    // When, from Clock::now().
+    uint64_t time;
+};
+
+
+/*!
+    @brief  Something that wants to hear about flashes.
+*/
+class Listener {
+  public:
+    virtual ~Listener() = default;
+
+    /*!
+      @param event  The flash.
+      @param now  When it's being delivered, which can be a few frames
+             after it happened.
+    */
+    virtual void on_flash(const FlashEvent& event, uint64_t now) = 0;
+};
+
+
+/*!
+    @brief  Lets fireflies see each other. Flash starts are published
+            into a fixed size queue, and handed out to every listener a
+            few at a time as a task, so however many fireflies flash at
+            once, a frame only ever delivers a batch of them. When the
+            queue is full, new events are dropped.
+
+            Give it to a Scheduler as a real-time task alongside the jar,
+            so events get delivered every frame.
+*/
+class EventBus : public Task {
+  private:
+    Clock& clock;
+    SpscQueue<FlashEvent, FIREFLY_EVENT_QUEUE> queue;
+    Listener* listeners[FIREFLY_MAX_LISTENERS];
+    uint8_t count;
+    // Most events delivered per run().
+    uint8_t batch;
+
+    uint32_t published;
+    uint32_t dropped;
+    uint32_t delivered;
+    uint32_t latency_max;
+    uint64_t latency_total;
+
+  public:
+    EventBus(Clock& clock, uint8_t batch = 4);
+
+    /*!
+      @brief  Listen for flashes from now on. Listeners can't leave.
+      @return false if there's no room for another listener.
+    */
+    bool subscribe(Listener& listener);
+
+    /*!
+      @brief  Queue a flash to be delivered.
+      @return false if the queue was full and it was dropped.
+    */
+    bool publish(const FlashEvent& event);
+
+    /*!
+      @brief  Deliver up to a batch of queued events to every listener.
+      @return How many events were delivered.
+    */
+    size_t dispatch(uint64_t now);
+
+    void run(uint32_t) override { this->dispatch(this->clock.now()); }
+
+    void reset();
+
+    size_t pending() const { return this->queue.size(); }
+    uint32_t get_published() const { return this->published; }
+    uint32_t get_dropped() const { return this->dropped; }
+    uint32_t get_delivered() const { return this->delivered; }
+    // How long events waited to be delivered, in microseconds.
+    uint32_t get_latency_max() const { return this->latency_max; }
+    uint64_t get_latency_total() const { return this->latency_total; }
+};
+
+}
@@ -0,0 +1,215 @@
+#include <firefly/config.hpp>
+#include <firefly/firefly.hpp>
+
+namespace firefly {
+
+Firefly::Firefly(uint16_t number, const Species& species) {
+    this->number = number;
+    this->species = &species;
+    this->phase = Phase::dark;
+    this->brightness = 0;
+    this->peak = species.peak_max - 1;
+    this->visible = false;
+    this->phase_start = 0;
+    this->dark_delay = 0;
+    this->rising_delay = species.rise_min_us;
+    this->falling_delay = species.fall_min_us;
+    this->unrolled = false;
+    this->rolls = 0;
+}
+
+
+void Firefly::roll(Rng& rng, const Timing& timing) {
+    const Species& species = *this->species;
+    Draws draws(rng, this->number, this->rolls++);
+    this->dark_delay = draws.random(timing.dark_min_ms, timing.dark_max_ms);
+    this->peak = draws.random(species.peak_min, species.peak_max);
+
+    // The length is folded into the step delays here, once per flash,
+    // so the steps themselves cost exactly what they always did.
+    uint32_t length = draws.random(species.length_min_pct, species.length_max_pct);
+    uint32_t rising = draws.random(timing.rise_min_us, timing.rise_max_us) * length / 100;
+    uint32_t falling = draws.random(timing.fall_min_us, timing.fall_max_us) * length / 100;
+    this->rising_delay = rising > UINT16_MAX ? UINT16_MAX : rising;
+    this->falling_delay = falling > UINT16_MAX ? UINT16_MAX : falling;
+    this->unrolled = false;
+}
+
+
+void Firefly::set_roll(uint16_t dark_delay, uint8_t peak, uint16_t rising_delay, uint16_t falling_delay) {
+    this->dark_delay = dark_delay;
+    this->peak = peak;
+    this->rising_delay = rising_delay;
+    this->falling_delay = falling_delay;
+    this->unrolled = false;
+    this->rolls++;
+}
+
+
+void Firefly::begin(uint64_t now, Rng& rng, const Timing& timing) {
+    this->roll(rng, timing);
+    this->phase = Phase::rising;
+    this->phase_start = now;
+    this->brightness = 0;
+    this->visible = this->dark_delay % 2 == 0;
+}
+
+
+void Firefly::warm(uint64_t now, Rng& rng, const Timing& timing) {
+    const Species& species = *this->species;
+    // No cycle is longer than this, so accepting one with probability
+    // length / longest picks them in proportion to their length. About
+    // half get accepted, and a handful of tries is plenty.
+    uint32_t longest = (uint32_t)timing.dark_max_ms * 1000
+                     + (uint32_t)species.peak_max * ((timing.rise_max_us + timing.fall_max_us) * species.length_max_pct / 100);
+    uint32_t dark, rise, length;
+    for (uint8_t tries = 0;; tries++) {
+        this->roll(rng, timing);
+        dark = (uint32_t)this->dark_delay * 1000;
+        rise = (uint32_t)this->peak * this->rising_delay;
+        length = dark + rise + (uint32_t)this->peak * this->falling_delay;
+        Draws draws(rng, this->number, this->rolls, WARM_SLOT);
+        if (tries == 15 || draws.random(0, longest) < length) {
+            break;
+        }
+    }
+
+    // Then somewhere in it. The phase may have started before the clock
+    // did, in which case phase_start wraps around, and all the sums on
+    // it wrap back.
+    Draws draws(rng, this->number, this->rolls, WARM_SLOT + 1);
+    uint32_t into = draws.random(0, length);
+    this->brightness = 0;
+    this->visible = this->dark_delay % 2 == 0;
+    if (into < dark) {
+        this->phase = Phase::dark;
+        this->phase_start = now - into;
+    } else if (into < dark + rise) {
+        this->phase = Phase::rising;
+        this->phase_start = now - (into - dark);
+    } else {
+        this->phase = Phase::falling;
+        this->phase_start = now - (into - dark - rise);
+    }
+}
+
+
+void Firefly::rest(uint64_t now, Rng& rng, const Timing& timing) {
+    this->roll(rng, timing);
+    this->phase = Phase::dark;
+    this->phase_start = now;
+    this->brightness = 0;
+}
+
+
+bool Firefly::answer(uint64_t flash, uint64_t now, Rng& rng, const Timing& timing) {
+    if (this->phase != Phase::dark) {
+        return false;
+    }
+    // Rounded down to even, so the answer is always shown.
+    Draws draws(rng, this->number, this->rolls, ANSWER_SLOT);
+    uint16_t delay = draws.random(timing.answer_min_ms, timing.answer_max_ms) & ~1u;
+    uint64_t at = flash + (uint32_t)delay * 1000;
+    // Too late, or she's going to flash (maybe to answer someone else)
+    // sooner than that anyway.
+    if (at <= now || at >= this->phase_start + (uint32_t)this->dark_delay * 1000) {
+        return false;
+    }
+    this->phase_start = flash;
+    this->dark_delay = delay;
+    return true;
+}
+
+
+Firefly::Checkpoint Firefly::save(uint64_t now) const {
+    uint64_t since = now - this->phase_start;
+    Checkpoint checkpoint;
+    checkpoint.since = since > UINT32_MAX ? UINT32_MAX : since;
+    checkpoint.rolls = this->rolls;
+    checkpoint.dark_delay = this->dark_delay;
+    checkpoint.rising_delay = this->rising_delay;
+    checkpoint.falling_delay = this->falling_delay;
+    checkpoint.peak = this->peak;
+    checkpoint.flags = (uint8_t)this->phase | this->visible << 2;
+    return checkpoint;
+}
+
+
+void Firefly::restore(const Checkpoint& checkpoint, uint64_t now) {
+    this->phase = (Phase)(checkpoint.flags & 3);
+    this->visible = checkpoint.flags & 4;
+    this->phase_start = now - checkpoint.since;
+    this->rolls = checkpoint.rolls;
+    this->dark_delay = checkpoint.dark_delay;
+    this->rising_delay = checkpoint.rising_delay;
+    this->falling_delay = checkpoint.falling_delay;
+    this->peak = checkpoint.peak;
+    this->brightness = 0;
+}
+
+
+FIREFLY_HOT bool Firefly::update(uint64_t now, Rng& rng, const Timing& timing) {
+    if (this->unrolled) {
+        this->roll(rng, timing);
+    }
+    return this->advance(now, &rng, &timing);
+}
+
+
+FIREFLY_HOT bool Firefly::update(uint64_t now) { return this->advance(now, nullptr, nullptr); }
+
+
+FIREFLY_HOT bool Firefly::advance(uint64_t now, Rng* rng, const Timing* timing) {
+    uint8_t previous = this->brightness;
+
+    // Normally this runs once, but if the loop stalled for a while we
+    // may have to walk through more than one phase to catch up.
+    for (;;) {
+        // No phase is anywhere near 71 minutes long, so once we know how
+        // far into it we are, 32 bits will do (and divide a lot faster
+        // on the ESP8266). A longer stall just walks through the phases.
+        uint64_t since = now - this->phase_start;
+        uint32_t elapsed = since > UINT32_MAX ? UINT32_MAX : since;
+
+        if (this->phase == Phase::dark) {
+            uint32_t length = (uint32_t)this->dark_delay * 1000;
+            if (elapsed < length) {
+                this->brightness = 0;
+                break;
+            }
+            this->phase_start += length;
+            this->phase = Phase::rising;
+            this->visible = this->dark_delay % 2 == 0;
+        } else if (this->phase == Phase::rising) {
+            uint32_t step = elapsed / this->rising_delay;
+            if (step < this->peak) {
+                this->brightness = step;
+                break;
+            }
+            // We've reached this flash's peak, so the
+            // rising phase is over and we begin falling.
+            this->phase_start += (uint32_t)this->peak * this->rising_delay;
+            this->phase = Phase::falling;
+        } else {
+            uint32_t step = elapsed / this->falling_delay;
+            if (step < this->peak) {
+                this->brightness = this->peak - step;
+                break;
+            }
+            // End of the falling phase. Re-roll the random values,
+            // and the rising phase begins again after a random delay.
+            this->phase_start += (uint32_t)this->peak * this->falling_delay;
+            this->phase = Phase::dark;
+            if (!rng) {
+                this->unrolled = true;
+                this->brightness = 0;
+                break;
+            }
+            this->roll(*rng, *timing);
+        }
+    }
+
+    return this->brightness != previous;
+}
+
+}
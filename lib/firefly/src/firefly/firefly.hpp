@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/rng.hpp>
+#include <firefly/species.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  What a firefly is doing right now.
+*/
+enum class Phase : uint8_t {
+    dark,
+    rising,
+    falling,
+};
+
+
+/*!
+    @brief  A single firefly. Each one is a small state machine that
+            goes dark -> rising -> falling -> dark, with its own random
+            timings re-rolled every time it goes dark. Rather than
+            stepping the brightness one notch per call, the brightness
+            is worked out from how long the firefly has been in its
+            current phase. That way it doesn't matter how often (or
+            how late) update() is called, the flash always looks the
+            same, and nothing here needs to know about the Arduino.
+*/
+class Firefly {
+  private:
+    const Species* species;
+
+    Phase phase;
+    uint8_t brightness;
+    // How bright this flash gets, and so how many steps its rise and
+    // fall each take.
+    uint8_t peak;
+    bool visible;
+    uint64_t phase_start;
+
+    uint16_t dark_delay;
+    uint16_t rising_delay;
+    uint16_t falling_delay;
+
+    // Set when a flash ended in update(now), until the next roll.
+    bool unrolled;
+
+    // How many times the firefly has rolled, which is what its draws
+    // from a CounterRng are keyed to. Answers draw from a slot well past
+    // any roll's.
+    uint32_t rolls;
+    static constexpr uint8_t ANSWER_SLOT = 16;
+    static constexpr uint8_t WARM_SLOT = 24;
+
+    /*!
+      @brief Both update()s: without an Rng, stop where it would roll.
+    */
+    bool advance(uint64_t now, Rng* rng, const Timing* timing);
+
+  public:
+    // How many draws a roll takes.
+    static constexpr uint8_t ROLL_DRAWS = 5;
+
+    /*!
+        @brief  A firefly squeezed into 16 bytes, for a Jar::Checkpoint.
+                Where it is in its phase is kept as how long it has been
+                in it, not when that was, since the clock it's restored
+                against may have started over.
+    */
+    struct Checkpoint {
+        uint32_t since;
+        uint32_t rolls;
+        uint16_t dark_delay;
+        uint16_t rising_delay;
+        uint16_t falling_delay;
+        uint8_t peak;
+        // The phase in the low two bits, and whether it's visible above.
+        uint8_t flags;
+    };
+
+    // Constructor: Taking the number in sequence of the LED to control,
+    // and the species it should behave like. This is zero indexed, by the way.
+    Firefly(uint16_t number, const Species& species);
+    // A dark P. Pyralis on LED 0, so fireflies can be kept in a std::array.
+    Firefly() : Firefly(0, species::p_pyralis) {}
+
+    uint16_t number;
+
+    /*!
+      @brief Re-rolls the randomness values of the firefly: how long
+             until the next flash, how bright it gets and how long
+             each step of it takes. The draws are keyed to the firefly's
+             number and how many times it has rolled (see Rng::draw()).
+      @param rng  Where the randomness comes from.
+      @param timing  The ranges to roll from.
+    */
+    void roll(Rng& rng, const Timing& timing);
+
+    /*!
+      @brief Take timings rolled elsewhere (see Rolls) from the draws
+             roll() would have made, and count them as a roll.
+    */
+    void set_roll(uint16_t dark_delay, uint8_t peak, uint16_t rising_delay, uint16_t falling_delay);
+
+    /*!
+      @brief Start a fresh flash at the given time, as if the firefly
+             just came out of the dark.
+      @param now  Current time in microseconds, from Clock::now().
+      @param rng  Where the randomness comes from.
+      @param timing  The ranges to roll from.
+    */
+    void begin(uint64_t now, Rng& rng, const Timing& timing);
+
+    /*!
+      @brief Start somewhere in the middle of things, as if the firefly
+             had been out for a long time already: at a random point of
+             a random cycle (dark, rise and fall). Longer cycles take up
+             more of a firefly's time, so they're picked in proportion
+             to their length, the way a glance at a jar that's been going
+             all evening would catch them. That way a jar full of these
+             looks the same from its first frame as it does an hour in,
+             rather than every firefly flashing at once.
+      @param now  Current time in microseconds, from Clock::now().
+      @param rng  Where the randomness comes from.
+      @param timing  The ranges to roll from.
+    */
+    void warm(uint64_t now, Rng& rng, const Timing& timing);
+
+    /*!
+      @brief Start off dark, as if a flash just ended at the given time.
+      @param now  Current time in microseconds, from Clock::now().
+      @param rng  Where the randomness comes from.
+      @param timing  The ranges to roll from.
+    */
+    void rest(uint64_t now, Rng& rng, const Timing& timing);
+
+    /*!
+      @brief Answer another firefly's flash, as a female does: flash
+             once, a while after it started. Only a firefly that's dark
+             can answer, and only if it's not already too late to and
+             she wasn't going to flash before then anyway.
+      @param flash  When the flash being answered started.
+      @param now  Current time in microseconds, from Clock::now().
+      @param rng  Where the randomness comes from.
+      @param timing  The range to roll the delay from.
+      @return true if the answer is on its way.
+    */
+    bool answer(uint64_t flash, uint64_t now, Rng& rng, const Timing& timing);
+
+    /*!
+      @brief Bring the firefly up to date. This is called in the main loop.
+             However far `now` has moved on, it only walks through the
+             phases in between, never their brightness steps, so it also
+             serves to seek (see Jar::seek()).
+      @param now  Current time in microseconds, from Clock::now().
+      @param rng  Used to re-roll timings whenever a flash ends.
+      @param timing  The ranges to re-roll from.
+      @return true if the brightness changed since the last call.
+    */
+    bool update(uint64_t now, Rng& rng, const Timing& timing);
+
+    /*!
+      @brief The same, except that a flash ending leaves the firefly dark
+             with its old timings, and is_unrolled(), for the caller to
+             roll for (along with everyone else's, see Rolls) and then
+             update() again.
+      @param now  Current time in microseconds, from Clock::now().
+      @return true if the brightness changed since the last call.
+    */
+    bool update(uint64_t now);
+
+    bool is_unrolled() const { return this->unrolled; }
+    uint32_t get_rolls() const { return this->rolls; }
+
+    /*!
+      @brief Write down where the firefly has got to. One that hasn't
+             been updated for over an hour (because it's resting, say)
+             is written down as having been in its phase for just over
+             an hour, which is all update() would make of it anyway.
+      @param now  Current time in microseconds, from Clock::now().
+    */
+    Checkpoint save(uint64_t now) const;
+
+    /*!
+      @brief Carry on from a checkpoint, as if it had been saved at the
+             given time. The brightness is worked out again by the next
+             update().
+      @param now  When the checkpoint was saved, from this Clock::now().
+    */
+    void restore(const Checkpoint& checkpoint, uint64_t now);
+
+    uint8_t get_brightness() const { return this->brightness; }
+    uint8_t get_peak() const { return this->peak; }
+    uint16_t get_rising_delay() const { return this->rising_delay; }
+    Phase get_phase() const { return this->phase; }
+    const Species& get_species() const { return *this->species; }
+    void set_species(const Species& species) { this->species = &species; }
+
+    /*!
+      @brief Whether this flash should actually be shown. Only the flashes
+             following an even dark_delay are, which (arbitrarily) adds a
+             bit more variability. This holds through the dark phase that
+             follows, so that the final step down to 0 is still shown.
+    */
+    bool is_visible() const { return this->visible; }
+};
+
+}
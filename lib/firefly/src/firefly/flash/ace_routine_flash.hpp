@@ -0,0 +1,54 @@
+#pragma once
+
+// AceRoutine needs the Arduino, so this one only exists on the ESP8266.
+#ifdef ARDUINO
+
+#include <AceRoutine.h>
+
+#include <firefly/config.hpp>
+#include <firefly/flash/params.hpp>
+
+namespace firefly {
+namespace flash {
+
+/*!
+    @brief  The flash as it was originally written, as a class extending
+            ace_routine::Coroutine. The coroutine reads micros() itself,
+            so the time given to resume() is ignored. The device
+            benchmark's baseline, and not used anywhere else.
+*/
+class AceRoutineFlash : public ace_routine::Coroutine, public Params {
+  public:
+    AceRoutineFlash(const Species& species, Rng& rng) : Params(species, rng) {}
+
+    void resume(uint32_t) { this->runCoroutine(); }
+
+    FIREFLY_HOT int runCoroutine() override {
+        COROUTINE_LOOP() {
+            if (this->rising) {
+                this->brightness++;
+            } else {
+                this->brightness--;
+            }
+
+            if (this->brightness == this->peak && this->rising) {
+                this->rising = false;
+            } else if (this->brightness == 0 && this->rising == false) {
+                this->rising = true;
+                this->roll();
+                COROUTINE_DELAY(this->dark_delay);
+            }
+
+            if (this->rising) {
+                COROUTINE_DELAY_MICROS(this->rising_delay);
+            } else {
+                COROUTINE_DELAY_MICROS(this->falling_delay);
+            }
+        }
+    }
+};
+
+}
+}
+
+#endif
@@ -0,0 +1,107 @@
+#pragma once
+
+// C++20 coroutines. The ESP8266 toolchain doesn't do these, so this one
+// only exists on the host, and only when built with -std=gnu++20.
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+
+#include <coroutine>
+#include <stddef.h>
+#include <stdint.h>
+#include <new>
+
+#include <firefly/flash/params.hpp>
+
+namespace firefly {
+namespace flash {
+
+/*!
+    @brief  The flash as a C++20 stackless coroutine. It reads just like
+            the AceRoutine version, but the compiler builds the state
+            machine, and the coroutine frame lives on the heap. Only the
+            host benchmarks use it.
+*/
+class CoroutineFlash : public Params {
+  private:
+    struct Task {
+        struct promise_type {
+            // Remember how big the compiler made the coroutine frame,
+            // since that's part of what each firefly costs.
+            static void* operator new(size_t size) {
+                last_frame_size = size;
+                return ::operator new(size);
+            }
+            static void operator delete(void* frame) { ::operator delete(frame); }
+
+            Task get_return_object() {
+                return Task{std::coroutine_handle<promise_type>::from_promise(*this)};
+            }
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() {}
+        };
+
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    struct Delay {
+        CoroutineFlash* flash;
+        uint32_t length;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<>) noexcept { this->flash->wait = this->length; }
+        void await_resume() const noexcept {}
+    };
+
+    uint32_t wait_start;
+    uint32_t wait;
+    std::coroutine_handle<Task::promise_type> handle;
+
+    Delay delay(uint32_t length) { return Delay{this, length}; }
+
+    Task run() {
+        for (;;) {
+            if (this->rising) {
+                this->brightness++;
+            } else {
+                this->brightness--;
+            }
+
+            if (this->brightness == this->peak && this->rising) {
+                this->rising = false;
+            } else if (this->brightness == 0 && this->rising == false) {
+                this->rising = true;
+                this->roll();
+                co_await this->delay((uint32_t)this->dark_delay * 1000 + this->rising_delay);
+                continue;
+            }
+
+            co_await this->delay(this->rising ? this->rising_delay : this->falling_delay);
+        }
+    }
+
+  public:
+    // Size of the most recently created coroutine frame, in bytes.
+    static inline size_t last_frame_size = 0;
+
+    CoroutineFlash(const Species& species, Rng& rng)
+        : Params(species, rng), wait_start(0), wait(0), handle(this->run().handle) {}
+
+    ~CoroutineFlash() { this->handle.destroy(); }
+
+    CoroutineFlash(const CoroutineFlash&) = delete;
+    CoroutineFlash& operator=(const CoroutineFlash&) = delete;
+
+    void resume(uint32_t now) {
+        if (now - this->wait_start < this->wait) {
+            return;
+        }
+        this->wait_start = now;
+        this->handle.resume();
+    }
+};
+
+}
+}
+
+#endif
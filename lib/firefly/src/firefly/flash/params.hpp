@@ -0,0 +1,56 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/rng.hpp>
+#include <firefly/species.hpp>
+
+namespace firefly {
+namespace flash {
+
+/*!
+    @brief  The state every stepped flash implementation shares: the
+            current brightness, which way it's going, and the timings
+            for this flash. The implementations in this directory all
+            step the brightness one notch at a time, exactly like the
+            original ace_routine::Coroutine based Firefly did, and only
+            differ in how they remember where they were between steps.
+            They exist only so that those ways can be compared by the
+            flash benchmarks (src/bench and src/bench_device), and
+            nothing in firefly.hpp includes them. The Jar itself uses
+            the Firefly state machine, which doesn't step.
+*/
+struct Params {
+    const Species* species;
+    Rng* rng;
+
+    uint8_t brightness;
+    uint8_t peak;
+    bool rising;
+
+    uint16_t dark_delay;
+    uint16_t rising_delay;
+    uint16_t falling_delay;
+
+    Params(const Species& species, Rng& rng)
+        : species(&species), rng(&rng), brightness(0), rising(true) {
+        this->roll();
+    }
+
+    /*!
+      @brief Re-rolls the randomness values of the flash.
+    */
+    void roll() {
+        const Species& s = *this->species;
+        this->dark_delay = this->rng->random(s.dark_min_ms, s.dark_max_ms);
+        this->peak = this->rng->random(s.peak_min, s.peak_max);
+        uint32_t length = this->rng->random(s.length_min_pct, s.length_max_pct);
+        this->rising_delay = this->rng->random(s.rise_min_us, s.rise_max_us) * length / 100;
+        this->falling_delay = this->rng->random(s.fall_min_us, s.fall_max_us) * length / 100;
+    }
+
+    uint8_t get_brightness() const { return this->brightness; }
+};
+
+}
+}
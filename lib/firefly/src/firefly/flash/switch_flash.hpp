@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/flash/params.hpp>
+
+namespace firefly {
+namespace flash {
+
+/*!
+    @brief  The flash written out as an explicit state machine. Where the
+            coroutine version remembers its place with a jump label, this
+            remembers it with a state and a switch, and the delay is just
+            a start time and a length. For benchmarking against the
+            others (see Params), not for a jar.
+*/
+class SwitchFlash : public Params {
+  private:
+    enum class State : uint8_t {
+        rising,
+        falling,
+    };
+
+    State state;
+    uint32_t wait_start;
+    uint32_t wait;
+
+  public:
+    SwitchFlash(const Species& species, Rng& rng)
+        : Params(species, rng), state(State::rising), wait_start(0), wait(0) {}
+
+    /*!
+      @brief Take the next brightness step, if it's due.
+      @param now  Current time in microseconds.
+    */
+    void resume(uint32_t now) {
+        if (now - this->wait_start < this->wait) {
+            return;
+        }
+        this->wait_start = now;
+
+        switch (this->state) {
+            case State::rising:
+                this->brightness++;
+                if (this->brightness == this->peak) {
+                    this->rising = false;
+                    this->state = State::falling;
+                    this->wait = this->falling_delay;
+                } else {
+                    this->wait = this->rising_delay;
+                }
+                break;
+
+            case State::falling:
+                this->brightness--;
+                if (this->brightness == 0) {
+                    // The dark delay and the first rising step
+                    // are one wait rather than two.
+                    this->rising = true;
+                    this->state = State::rising;
+                    this->roll();
+                    this->wait = (uint32_t)this->dark_delay * 1000 + this->rising_delay;
+                } else {
+                    this->wait = this->falling_delay;
+                }
+                break;
+        }
+    }
+};
+
+}
+}
@@ -0,0 +1,70 @@
+#pragma once
+
+// Glue between the engine and a normal computer, for the simulator and
+// the benchmarks. Header only, like firefly/arduino.hpp, so device builds
+// never try to compile it.
+#ifndef ARDUINO
+
+#include <chrono>
+#include <cstdio>
+
+#include <firefly/clock.hpp>
+#include <firefly/sensors.hpp>
+
+namespace firefly {
+namespace host {
+
+/*!
+    @brief  Clock backed by the computer's monotonic clock.
+*/
+class SteadyClock : public Clock {
+  public:
+    uint32_t micros() override {
+        using namespace std::chrono;
+        return duration_cast<microseconds>(steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+
+/*!
+    @brief  A thermometer that reads a file holding a temperature in
+            degrees Celsius, like the ones under /sys/class/thermal (which
+            are in thousandths, so pass a divisor of 1000 for those).
+            If the file can't be read, the reading is skipped.
+*/
+class FileTemperature : public TemperatureSensor {
+  private:
+    const char* path;
+    double divisor;
+    bool pending;
+
+  public:
+    explicit FileTemperature(const char* path, double divisor = 1)
+        : path(path), divisor(divisor), pending(false) {}
+
+    void request() override { this->pending = true; }
+
+    bool poll(int16_t& decicelsius) override {
+        if (!this->pending) {
+            return false;
+        }
+        this->pending = false;
+
+        std::FILE* file = std::fopen(this->path, "r");
+        if (!file) {
+            return false;
+        }
+        double value;
+        bool ok = std::fscanf(file, "%lf", &value) == 1;
+        std::fclose(file);
+        if (ok) {
+            decicelsius = (int16_t)(value / this->divisor * 10);
+        }
+        return ok;
+    }
+};
+
+}
+}
+
+#endif
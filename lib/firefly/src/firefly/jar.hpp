@@ -0,0 +1,769 @@
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <firefly/clock.hpp>
+#include <firefly/compositor.hpp>
+#include <firefly/config.hpp>
+#include <firefly/events.hpp>
+#include <firefly/firefly.hpp>
+#include <firefly/noise.hpp>
+#include <firefly/output.hpp>
+#include <firefly/rng.hpp>
+#include <firefly/rolls.hpp>
+#include <firefly/species.hpp>
+#include <firefly/task.hpp>
+#include <firefly/timeline.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  The jar: N fireflies, one per LED, plus the clock, randomness
+            and output they share. The platform provides the Clock, Rng
+            and OutputSink; the jar doesn't care whether those are an
+            ESP8266 and a strip of WS2812Bs or a simulator.
+
+            The number of fireflies is a template parameter so that the
+            storage, the frame buffer and every loop over them have a
+            size the compiler knows about. It also means a jar that
+            won't fit (in RAM, or in the time between two brightness
+            steps) fails to compile instead of misbehaving on the jar.
+
+            The jar is also the render Task; give it to a Scheduler as a
+            real-time task with a period of FIREFLY_FRAME_PERIOD_US.
+
+            Not every firefly has to be out. The jar keeps the ones that
+            are at the front of a list and only ever looks at those, so
+            a jar that's mostly resting does proportionally less work.
+            With a Timeline, how many are out (and how long they wait
+            between flashes) follows the time of night.
+
+            With an EventBus, some of the fireflies can be females: they
+            rarely flash on their own, but answer the males' flashes
+            after a delay, the way P. Pyralis court.
+
+            Fireflies can also be held out of the jar altogether (eaten
+            by a Predator, say) and let back in later. Holding and
+            releasing are O(1) swaps in the same list, so nothing moves
+            or gets allocated however often it happens.
+    @tparam N  Number of LEDs, and so fireflies, in the jar.
+    @tparam S  Species every firefly in the jar starts out as.
+*/
+template <size_t N, const Species& S = species::p_pyralis>
+class Jar : public Task, public Listener {
+  public:
+    static constexpr size_t size() { return N; }
+
+    // How long one frame takes to go out over the wire.
+    static constexpr uint32_t wire_us = N * FIREFLY_WIRE_US_PER_LED + FIREFLY_WIRE_LATCH_US;
+    // How long it's allowed to take.
+    static constexpr uint32_t frame_budget_us =
+        FIREFLY_FRAME_BUDGET_US ? FIREFLY_FRAME_BUDGET_US : S.rise_min_us;
+
+    // How often the timeline is looked at, in microseconds. Activity
+    // changes over minutes, so there's no point doing it every frame.
+    static constexpr uint32_t activity_period_us = 1000000;
+
+    // Bumped whenever Checkpoint changes, so an old one isn't misread.
+    static constexpr uint8_t checkpoint_version = 1;
+
+    /*!
+        @brief  Everything needed to carry on exactly where the jar left
+                off: every firefly, the list of who's out, the timeline,
+                and where the Rng has got to. It's kept small enough for
+                the ESP8266's RTC memory (FIREFLY_RTC_BYTES), the only
+                thing that survives deep sleep, which is about 25
+                fireflies' worth. Times are kept relative to when it was
+                saved, since the clock starts over on waking.
+
+                What the jar was set up with (species, courtship, flicker,
+                the timeline itself) isn't in here: set the jar up the
+                same way again, then restore().
+    */
+    struct Checkpoint {
+        // A hash of everything after it, so that whatever RTC memory
+        // holds after a power cut isn't taken for a checkpoint.
+        uint32_t check;
+        // Until the timeline is next looked at; negative if it's late.
+        int32_t until_activity;
+        // How long the jar expects to be asleep before it's restored.
+        uint64_t sleep_us;
+        uint64_t since_dusk;
+        uint32_t rng[2];
+        uint32_t answers;
+        uint16_t count;
+        uint16_t active;
+        uint16_t available;
+        int16_t temperature;
+        uint8_t version;
+        uint8_t activity;
+        uint8_t brightness;
+        uint8_t paused;
+        std::array<uint16_t, N> order;
+        std::array<Firefly::Checkpoint, N> fireflies;
+    };
+
+  private:
+    Clock& clock;
+    Rng& rng;
+
+    std::array<Firefly, N> fireflies;
+    Compositor<N> compositor;
+
+    // Firefly numbers, the first `active` of which are out, and the
+    // first `available` of which aren't held. slot[i] is where firefly
+    // i is in that list, so either can be found in O(1).
+    std::array<uint16_t, N> order;
+    std::array<uint16_t, N> slot;
+    uint16_t active;
+    uint16_t available;
+
+    // What the fireflies roll their timings from right now. Females
+    // have their own, since they mostly wait to be answering someone,
+    // and so do mimics, since they're another species altogether.
+    Timing timing;
+    Timing female_timing;
+    Timing mimic_timing;
+
+    // Where male flashes go, how many fireflies (the first ones) are
+    // female, and how many of those (the first ones again) are another
+    // species only pretending to be (see set_mimics()).
+    EventBus* bus;
+    uint16_t females;
+    const Species* mimic;
+    uint16_t mimics;
+    uint32_t answers;
+
+    const Timeline* timeline;
+    uint64_t dusk;
+    uint64_t next_activity;
+    uint8_t activity;
+
+    int16_t temperature;
+
+    // While paused (in daylight, say), nothing is updated at all.
+    bool paused;
+
+    // How deep the flicker goes (0 for none), and how fast it moves, in
+    // 1/65536ths of a noise cell every 1024 us.
+    uint8_t flicker_depth;
+    uint16_t flicker_step;
+
+    // Fireflies whose flashes ended this frame, rolled for together.
+    Rolls<(N < FIREFLY_ROLL_BATCH ? N : FIREFLY_ROLL_BATCH)> rolls;
+
+    /*!
+      @brief Put a resting firefly back out. It starts off dark, so it
+             doesn't pop on all at once.
+    */
+    void activate(uint16_t index, uint64_t now) {
+        this->swap(this->slot[index], this->active);
+        this->active++;
+        this->fireflies[index].rest(now, this->rng, this->timing_of(index));
+    }
+
+    /*!
+      @brief Stop updating a firefly. Its LED is left as it is, so this
+             is only done while it's dark, or by hold(), which turns the
+             LED off itself.
+    */
+    void deactivate(uint16_t index) {
+        this->active--;
+        this->swap(this->slot[index], this->active);
+    }
+
+    void swap(uint16_t a, uint16_t b) {
+        uint16_t first = this->order[a];
+        uint16_t second = this->order[b];
+        this->order[a] = second;
+        this->order[b] = first;
+        this->slot[second] = a;
+        this->slot[first] = b;
+    }
+
+    /*!
+      @brief Catch up with the timeline: rescale the timings for every
+             firefly in one go, and put fireflies out or away until the
+             right number are out. Fireflies that are mid-flash are left
+             to finish, and get put away on a later pass.
+    */
+    void apply_activity(uint64_t now) {
+        this->next_activity = now + activity_period_us;
+        // Nobody's out before dusk.
+        this->activity = (int64_t)(now - this->dusk) < 0 ? 0 : this->timeline->activity_at(now - this->dusk);
+        this->retime();
+
+        uint16_t target = (N * this->activity + 254) / 255;
+        while (this->active < target && this->active < this->available) {
+            this->activate(this->order[this->active], now);
+        }
+        for (uint16_t k = this->active; k > 0 && this->active > target; k--) {
+            uint16_t index = this->order[k - 1];
+            if (this->fireflies[index].get_phase() == Phase::dark) {
+                this->deactivate(index);
+            }
+        }
+    }
+
+    /*!
+      @brief Work out the timing ranges from the species, activity and
+             temperature. The less active the night, the longer the dark
+             between flashes, up to three times as long when almost
+             nobody's out. Temperature scales every interval by the
+             species' rate curve.
+    */
+    void retime() {
+        this->timing = this->scaled(S);
+
+        // Females do flash on their own now and then, just eight times
+        // less often than males.
+        this->female_timing = female(this->timing);
+
+        // Mimics are females too, but flash their own species' flashes.
+        this->mimic_timing = this->mimic ? female(this->scaled(*this->mimic)) : this->female_timing;
+    }
+
+    Timing scaled(const Species& species) const {
+        Timing timing = Timing::of(species);
+        uint32_t stretch = 256 + 2 * (255 - this->activity);
+        uint32_t scale = species.interval_scale(this->temperature);
+        uint32_t dark = stretch * scale / 256;
+        timing.dark_min_ms = clamp16(timing.dark_min_ms * dark / 256);
+        timing.dark_max_ms = clamp16(timing.dark_max_ms * dark / 256);
+        timing.rise_min_us = clamp16(timing.rise_min_us * scale / 256);
+        timing.rise_max_us = clamp16(timing.rise_max_us * scale / 256);
+        timing.fall_min_us = clamp16(timing.fall_min_us * scale / 256);
+        timing.fall_max_us = clamp16(timing.fall_max_us * scale / 256);
+        timing.answer_min_ms = clamp16(timing.answer_min_ms * scale / 256);
+        timing.answer_max_ms = clamp16(timing.answer_max_ms * scale / 256);
+        return timing;
+    }
+
+    static Timing female(Timing timing) {
+        timing.dark_min_ms = clamp16(timing.dark_min_ms * 8);
+        timing.dark_max_ms = clamp16(timing.dark_max_ms * 8);
+        return timing;
+    }
+
+    /*!
+      @brief Timeline::until_active() from a time rather than from dusk,
+             counting a dusk still to come as quiet until then.
+      @param at  From Clock::now().
+    */
+    uint64_t until_active(uint64_t at) const {
+        if ((int64_t)(at - this->dusk) < 0) {
+            uint64_t after = this->timeline->until_active(0);
+            return after == UINT64_MAX ? UINT64_MAX : this->dusk - at + after;
+        }
+        return this->timeline->until_active(at - this->dusk);
+    }
+
+    const Timing& timing_of(uint16_t index) const {
+        return index < this->mimics  ? this->mimic_timing
+             : index < this->females ? this->female_timing
+             : this->timing;
+    }
+
+    /*!
+      @brief Bring every firefly that's out up to a time, and nothing
+             else: no drawing, no publishing.
+    */
+    void catch_up(uint64_t now) {
+        for (uint16_t k = 0; k < this->active; k++) {
+            uint16_t i = this->order[k];
+            this->fireflies[i].update(now, this->rng, this->timing_of(i));
+        }
+    }
+
+    static uint16_t clamp16(uint32_t value) { return value > UINT16_MAX ? UINT16_MAX : value; }
+
+    /*!
+      @brief FNV-1a over a checkpoint, all but the check itself. It's
+             zeroed before it's filled in, padding and all, so the same
+             jar always hashes the same.
+    */
+    static uint32_t checksum(const Checkpoint& checkpoint) {
+        const uint8_t* bytes = (const uint8_t*)&checkpoint;
+        uint32_t hash = 2166136261u;
+        for (size_t i = sizeof(checkpoint.check); i < sizeof(Checkpoint); i++) {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    /*!
+      @brief Knock a lit firefly's brightness down by some noise. Each
+             firefly reads the noise from its own far-off spot, so no two
+             flicker together.
+      @param drift  Where the noise has got to this frame.
+    */
+    FIREFLY_HOT uint8_t flicker(uint16_t index, uint8_t brightness, uint32_t drift) const {
+        uint8_t n = noise::sample((drift >> 8) + index * 0x9E37u);
+        return brightness - ((brightness * this->flicker_depth * n) >> 16);
+    }
+
+  public:
+    Jar(OutputSink& sink, Clock& clock, Rng& rng)
+        : clock(clock), rng(rng), compositor(sink), active(0), available(N), timing(Timing::of(S)),
+          female_timing(Timing::of(S)), mimic_timing(Timing::of(S)), bus(nullptr), females(0), mimic(nullptr), mimics(0), answers(0), timeline(nullptr), dusk(0), next_activity(0), activity(255),
+          temperature(S.reference_decicelsius), paused(false), flicker_depth(0), flicker_step(0) {
+        static_assert(N > 0, "A jar needs at least one firefly");
+        static_assert(N <= UINT16_MAX, "Fireflies are numbered with 16 bits");
+        // The strip keeps 3 bytes per LED of its own on top of the jar,
+        // and the species' color table is in RAM too (see ColorTable).
+        // Mimics bring a table of their own, which can't be known here.
+        static_assert(sizeof(Jar) + 3 * N + sizeof(ColorTable) <= FIREFLY_RAM_BUDGET,
+                      "Jar does not fit FIREFLY_RAM_BUDGET, use fewer LEDs or raise the budget");
+        static_assert(wire_us <= frame_budget_us,
+                      "Showing this many LEDs takes longer than a brightness step, "
+                      "use fewer LEDs or raise FIREFLY_FRAME_BUDGET_US");
+    }
+
+    /*!
+      @brief Turn every LED off and put one firefly on each, each at its
+             own point of its cycle (see Firefly::warm()), so the jar
+             doesn't start with everyone flashing at once.
+    */
+    void begin() {
+        uint64_t now = this->clock.now();
+
+        for (size_t i = 0; i < N; i++) {
+            this->fireflies[i] = Firefly(i, S);
+            this->fireflies[i].warm(now, this->rng, this->timing_of(i));
+            this->order[i] = i;
+            this->slot[i] = i;
+        }
+        this->active = N;
+        this->available = N;
+        this->compositor.clear();
+        this->compositor.show();
+    }
+
+    /*!
+      @brief Follow a timeline from now on.
+      @param timeline  The activity curve. Must outlive the jar.
+      @param dusk  When dusk was, from Clock::now(). If it's still to
+             come, nobody's out until it does.
+    */
+    void set_timeline(const Timeline& timeline, uint64_t dusk) {
+        this->timeline = &timeline;
+        this->dusk = dusk;
+        this->next_activity = 0;
+    }
+
+    /*!
+      @brief Have some of the fireflies court the others. Every visible
+             flash a male starts is published on the bus, and the jar
+             listens on it for flashes for its females to answer.
+      @param bus  Where flashes go. Must outlive the jar, and be run
+             as a task itself so they get delivered.
+      @param females  How many fireflies are female. Call this before
+             begin(), so they start out on their own timings.
+    */
+    void set_courtship(EventBus& bus, uint16_t females) {
+        this->bus = &bus;
+        this->females = females > N ? N : females;
+        bus.subscribe(*this);
+        this->retime();
+    }
+
+    /*!
+      @brief A male flashed (here or in another jar on the same bus), so
+             pick a female at random to answer him. If she's busy, out
+             or already flashing, nobody answers: it's only ever one try,
+             so delivering an event costs the same however many females
+             there are. Mimics are never picked; whatever set them up
+             answers for them.
+    */
+    void on_flash(const FlashEvent& event, uint64_t now) override {
+        if (this->females > this->mimics) {
+            this->answer(this->rng.random(this->mimics, this->females), event.time, now);
+        }
+    }
+
+    /*!
+      @brief Have a female answer a flash, if she's out and free to.
+      @param index  Which female.
+      @param flash  When the flash she's answering started.
+      @param now  From Clock::now().
+      @return true if she's going to.
+    */
+    bool answer(uint16_t index, uint64_t flash, uint64_t now) {
+        if (this->paused || !this->is_active(index)
+            || !this->fireflies[index].answer(flash, now, this->rng, this->female_timing)) {
+            return false;
+        }
+        this->answers++;
+        return true;
+    }
+
+    /*!
+      @brief Take a firefly out of the jar, whatever it's doing. Its
+             LED goes off, and it stays out (the timeline won't put it
+             back) until it's released.
+    */
+    void hold(uint16_t index) {
+        if (this->is_held(index)) {
+            return;
+        }
+        if (this->is_active(index)) {
+            this->deactivate(index);
+        }
+        this->available--;
+        this->swap(this->slot[index], this->available);
+        const Firefly& firefly = this->fireflies[index];
+        this->compositor.put(index, firefly.get_species(), 0);
+    }
+
+    /*!
+      @brief Put a held firefly back out. It starts off dark.
+    */
+    void release(uint16_t index) {
+        if (!this->is_held(index)) {
+            return;
+        }
+        this->swap(this->slot[index], this->available);
+        this->available++;
+        this->activate(index, this->clock.now());
+    }
+
+    /*!
+      @brief Make the first few females a different species, such as
+             predators mimicking the rest. They flash (in their own
+             color) with their own species' timings, scaled for the
+             night and the temperature like everyone's, and as seldom as
+             the females they hide among. When they answer a male with
+             answer(), it's with the jar's female timing, since that's
+             the point. The jar's own females are then only the rest.
+             Call after begin().
+      @param count  How many, up to the number of females.
+    */
+    void set_mimics(const Species& species, uint16_t count) {
+        this->mimic = &species;
+        this->mimics = count > this->females ? this->females : count;
+        for (uint16_t i = 0; i < this->mimics; i++) {
+            this->fireflies[i].set_species(species);
+        }
+        this->retime();
+    }
+
+    /*!
+      @brief Change the temperature the fireflies think it is. All the
+             timings are rescaled at once; flashes already under way
+             finish as they started.
+      @param decicelsius  Temperature in tenths of a degree Celsius.
+    */
+    void set_temperature(int16_t decicelsius) {
+        this->temperature = decicelsius;
+        this->retime();
+    }
+
+    /*!
+      @brief Scale the brightness of the whole jar, to suit the room.
+             Every lit LED is redrawn at the new brightness right away,
+             unless the jar is paused, in which case it's only kept for
+             when it resumes.
+      @param brightness  255 for full, 0 for off.
+    */
+    void set_brightness(uint8_t brightness) {
+        this->compositor.set_brightness(brightness);
+        if (this->paused) {
+            return;
+        }
+        for (uint16_t k = 0; k < this->active; k++) {
+            uint16_t i = this->order[k];
+            const Firefly& firefly = this->fireflies[i];
+            if (firefly.is_visible()) {
+                this->compositor.put(i, firefly.get_species(), firefly.get_brightness());
+            }
+        }
+        this->compositor.show();
+    }
+
+    /*!
+      @brief Make lit fireflies flicker a little, rather than glow as
+             perfectly smooth ramps. The flicker is worked out each frame
+             for the fireflies that are lit, and only them.
+      @param depth  How much of a firefly's brightness the flicker can
+             take away, 255 for all of it. 0 turns it off.
+      @param cells_per_second  How fast it moves. Around a dozen looks
+             like a flame; much more looks like a bad connection.
+    */
+    void set_flicker(uint8_t depth, uint8_t cells_per_second = 12) {
+        this->flicker_depth = depth;
+        this->flicker_step = (uint32_t)cells_per_second * 65536 * 1024 / 1000000;
+    }
+
+    /*!
+      @brief Have LEDs fade out over a few tens of milliseconds at the
+             end of a flash, instead of cutting off. See Compositor.
+      @param time_constant_ms  0 turns it off.
+    */
+    void set_afterglow(uint16_t time_constant_ms) { this->compositor.set_afterglow(time_constant_ms); }
+
+    /*!
+      @brief Stop (or restart) the whole jar. While paused every LED is
+             off and no firefly is updated, so the loop has next to
+             nothing to do. On resuming, every firefly starts off dark
+             so they don't all light up at once.
+    */
+    void set_paused(bool paused) {
+        if (paused == this->paused) {
+            return;
+        }
+        this->paused = paused;
+        if (paused) {
+            this->compositor.clear();
+            this->compositor.show();
+        } else {
+            uint64_t now = this->clock.now();
+            for (uint16_t k = 0; k < this->active; k++) {
+                uint16_t index = this->order[k];
+                this->fireflies[index].rest(now, this->rng, this->timing_of(index));
+            }
+            // Everyone's dark now, so start from a blank frame, with
+            // nothing left over to fade from.
+            this->compositor.clear();
+            this->compositor.show();
+        }
+    }
+
+    /*!
+      @brief Bring every firefly up to the current time and show
+             the result. Call this as often as possible.
+    */
+    FIREFLY_HOT_LOOP void update() {
+        // The clock is still read while paused, so it keeps track of
+        // its wraps however long the day is.
+        uint64_t now = this->clock.now();
+
+        if (this->paused) {
+            return;
+        }
+
+        // Compared by subtracting, since a restored jar can have been
+        // due before its clock started.
+        if (this->timeline && (int64_t)(now - this->next_activity) >= 0) {
+            this->apply_activity(now);
+        }
+
+        // Only the noise's position is worked out here; the noise
+        // itself only for fireflies that are lit.
+        uint32_t drift = (uint32_t)(now >> 10) * this->flicker_step;
+
+        // Every firefly is brought to the same point in time, and the
+        // strip is only shown once no matter how many of them changed.
+        // Those whose flashes end wait to be rolled for all together.
+        for (uint16_t k = 0; k < this->active; k++) {
+            uint16_t i = this->order[k];
+            Firefly& firefly = this->fireflies[i];
+            Phase before = firefly.get_phase();
+            bool changed = firefly.update(now);
+            if (firefly.is_visible()) {
+                uint8_t brightness = firefly.get_brightness();
+                if (this->flicker_depth && brightness) {
+                    this->compositor.put(i, firefly.get_species(), this->flicker(i, brightness, drift));
+                } else if (changed) {
+                    this->compositor.put(i, firefly.get_species(), brightness);
+                }
+            }
+            if (this->bus && before == Phase::dark && firefly.get_phase() != Phase::dark
+                && i >= this->females && firefly.is_visible()) {
+                this->bus->publish({i, now});
+            }
+            if (firefly.is_unrolled()) {
+                this->rolls.add(firefly, this->timing_of(i));
+                if (this->rolls.full()) {
+                    this->rolls.roll(this->rng);
+                    this->rolls.clear();
+                }
+            }
+        }
+        // They're dark until at least the next frame, so nothing about
+        // this one changes. (If the loop stalled for so long that one's
+        // dark is already over, it catches up then.)
+        if (!this->rolls.empty()) {
+            this->rolls.roll(this->rng);
+            this->rolls.clear();
+        }
+
+        this->compositor.show(now);
+    }
+
+    /*!
+      @brief Catch up with the clock in one go, however far it's moved
+             on. Each firefly jumps from one phase to the next rather
+             than through every brightness step in between, so seeking
+             an hour ahead costs as much as the flashes in that hour, not
+             every frame of it. With a timeline, the jumps stop at each
+             change of activity on the way, so timings change when they
+             would have. Flashes on the way aren't published, so nobody
+             answers them.
+
+             With a CounterRng, the fireflies end up just where calling
+             update() every frame would have left them; with any other,
+             they only end up somewhere just as likely.
+
+             While nobody's out and the timeline says nobody will be,
+             nothing changes, so those hours are skipped in one go.
+    */
+    void seek() {
+        uint64_t now = this->clock.now();
+
+        if (this->paused) {
+            return;
+        }
+
+        while (this->timeline && (int64_t)(now - this->next_activity) >= 0) {
+            uint64_t at = this->next_activity;
+            this->catch_up(at);
+            this->apply_activity(at);
+            if (this->active == 0 && this->activity == 0 && (int64_t)(now - this->next_activity) > 0) {
+                // Whole periods only, so the timeline is still looked
+                // at on the same beat as update() would have.
+                uint64_t quiet = this->until_active(this->next_activity);
+                uint64_t behind = now - this->next_activity;
+                uint64_t skip = quiet < behind ? quiet : behind;
+                this->next_activity += skip / activity_period_us * activity_period_us;
+            }
+        }
+        this->catch_up(now);
+
+        // Every LED is put afresh, since nothing on the way was.
+        uint32_t drift = (uint32_t)(now >> 10) * this->flicker_step;
+        this->compositor.clear();
+        for (uint16_t k = 0; k < this->active; k++) {
+            uint16_t i = this->order[k];
+            const Firefly& firefly = this->fireflies[i];
+            uint8_t brightness = firefly.is_visible() ? firefly.get_brightness() : 0;
+            if (this->flicker_depth && brightness) {
+                brightness = this->flicker(i, brightness, drift);
+            }
+            this->compositor.put(i, firefly.get_species(), brightness);
+        }
+        this->compositor.show(now);
+    }
+
+    /*!
+      @brief How long the jar will have nothing to do: with nobody out,
+             the microseconds until the timeline brings someone out (see
+             Timeline::until_active()). 0 while anyone's out, while
+             anyone's held (see save()), or without a timeline. If it's
+             long enough, sleep through it.
+    */
+    uint64_t get_quiet_us() {
+        if (!this->timeline || this->active > 0 || this->get_held() > 0) {
+            return 0;
+        }
+        return this->until_active(this->clock.now());
+    }
+
+    /*!
+      @brief Write down everything needed to carry on from here later,
+             even after deep sleep. This is a few hundred bytes copied,
+             so it can be done right before going to sleep. Fireflies
+             held by something else (a Predator, a Population) are saved
+             as the jar sees them, but whatever holds them keeps its own
+             state, and that isn't saved; so don't sleep while any are.
+      @param checkpoint  Where to write it.
+      @param sleep_us  How long the jar is about to sleep for, if it is,
+             which restore() then skips on by.
+    */
+    void save(Checkpoint& checkpoint, uint64_t sleep_us = 0) {
+        static_assert(sizeof(Checkpoint) <= FIREFLY_RTC_BYTES,
+                      "Jar::Checkpoint does not fit FIREFLY_RTC_BYTES, use fewer LEDs");
+        uint64_t now = this->clock.now();
+
+        memset(&checkpoint, 0, sizeof(checkpoint));
+        int64_t until = (int64_t)(this->next_activity - now);
+        checkpoint.until_activity = until < INT32_MIN ? INT32_MIN : until > INT32_MAX ? INT32_MAX : until;
+        checkpoint.sleep_us = sleep_us;
+        checkpoint.since_dusk = now - this->dusk;
+        this->rng.save(checkpoint.rng);
+        checkpoint.answers = this->answers;
+        checkpoint.count = N;
+        checkpoint.active = this->active;
+        checkpoint.available = this->available;
+        checkpoint.temperature = this->temperature;
+        checkpoint.version = checkpoint_version;
+        checkpoint.activity = this->activity;
+        checkpoint.brightness = this->compositor.get_brightness();
+        checkpoint.paused = this->paused;
+        checkpoint.order = this->order;
+        for (size_t i = 0; i < N; i++) {
+            checkpoint.fireflies[i] = this->fireflies[i].save(now);
+        }
+        checkpoint.check = checksum(checkpoint);
+    }
+
+    /*!
+      @brief Carry on from a checkpoint, however long ago (and on
+             whichever clock) it was saved. Set the jar up first, the
+             same way it was when it was saved, and begin() it. The jar
+             then seeks (see seek()) past however long the checkpoint
+             says it slept for, so with a CounterRng it ends up exactly
+             where it would have been if it had never stopped.
+      @return false, leaving the jar as it was, if this isn't a
+             checkpoint of a jar this size.
+    */
+    bool restore(const Checkpoint& checkpoint) {
+        if (checkpoint.version != checkpoint_version || checkpoint.count != N
+            || checkpoint.check != checksum(checkpoint)) {
+            return false;
+        }
+
+        // As if it was saved that long ago on this clock. Before the
+        // clock started, maybe, in which case this wraps around, and
+        // everything that subtracts from it wraps back.
+        uint64_t then = this->clock.now() - checkpoint.sleep_us;
+
+        for (size_t i = 0; i < N; i++) {
+            this->fireflies[i].restore(checkpoint.fireflies[i], then);
+            this->order[i] = checkpoint.order[i];
+            this->slot[checkpoint.order[i]] = i;
+        }
+        this->active = checkpoint.active;
+        this->available = checkpoint.available;
+        this->answers = checkpoint.answers;
+        this->temperature = checkpoint.temperature;
+        this->activity = checkpoint.activity;
+        this->paused = checkpoint.paused;
+        this->dusk = then - checkpoint.since_dusk;
+        this->next_activity = then + (int64_t)checkpoint.until_activity;
+        this->rng.restore(checkpoint.rng);
+        this->compositor.set_brightness(checkpoint.brightness);
+        this->retime();
+
+        if (this->paused) {
+            this->compositor.clear();
+            this->compositor.show();
+        } else {
+            this->seek();
+        }
+        return true;
+    }
+
+    void run(uint32_t) override { this->update(); }
+
+    const Firefly& operator[](size_t index) const { return this->fireflies[index]; }
+    bool is_active(size_t index) const { return this->slot[index] < this->active; }
+    bool is_held(size_t index) const { return this->slot[index] >= this->available; }
+    uint16_t get_active() const { return this->active; }
+    uint16_t get_held() const { return N - this->available; }
+    uint16_t get_females() const { return this->females; }
+    uint16_t get_mimics() const { return this->mimics; }
+    const Timing& get_female_timing() const { return this->female_timing; }
+    uint8_t get_activity() const { return this->activity; }
+    const Timing& get_timing() const { return this->timing; }
+    int16_t get_temperature() const { return this->temperature; }
+    const std::array<uint32_t, N>& get_frame() const { return this->compositor.get_frame(); }
+    uint8_t get_brightness() const { return this->compositor.get_brightness(); }
+    bool is_paused() const { return this->paused; }
+    bool is_female(size_t index) const { return index < this->females; }
+    uint32_t get_answers() const { return this->answers; }
+};
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <stdint.h>
+
+#include <firefly/config.hpp>
+
+namespace firefly {
+namespace noise {
+
+/*!
+    @brief  A random byte for every whole-number point of the noise. Made
+            at compile time with a xorshift, so it costs nothing to set
+            up and is the same on every build.
+*/
+constexpr std::array<uint8_t, 256> make_values() {
+    std::array<uint8_t, 256> values = {};
+    uint32_t state = 0x9E3779B9u;
+    for (auto& value : values) {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        value = state >> 24;
+    }
+    return values;
+}
+
+/*!
+    @brief  Smoothstep, 3f^2 - 2f^3, for f from 0 to 255/256, scaled to
+            0-255. Easing between points like this is what makes the
+            noise wander rather than zig-zag.
+*/
+constexpr std::array<uint8_t, 256> make_smooth() {
+    std::array<uint8_t, 256> smooth = {};
+    for (uint32_t f = 0; f < 256; f++) {
+        smooth[f] = f * f * (3 * 256 - 2 * f) >> 16;
+    }
+    return smooth;
+}
+
+// Both are 256 bytes. On the ESP8266 they live in RAM, where reading
+// them costs no more than reading a register.
+inline constexpr std::array<uint8_t, 256> values = make_values();
+inline constexpr std::array<uint8_t, 256> smooth = make_smooth();
+
+
+/*!
+    @brief  One dimensional value noise: random at every whole number,
+            and smoothly in between. It repeats every 256.
+    @param  x  Where, in 1/256ths.
+    @return 0 to 255.
+*/
+FIREFLY_HOT inline uint8_t sample(uint32_t x) {
+    uint8_t cell = x >> 8;
+    int16_t a = values[cell];
+    int16_t b = values[(uint8_t)(cell + 1)];
+    return a + (((b - a) * smooth[x & 0xFF]) >> 8);
+}
+
+}
+}
@@ -0,0 +1,40 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/calibration.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  Where finished colors go. On the ESP8266 this wraps an
+            Adafruit_NeoPixel strip, in the simulator it's a buffer
+            or the terminal.
+*/
+class OutputSink {
+  public:
+    virtual ~OutputSink() = default;
+
+    /*!
+      @brief  Set the color of one LED. Nothing is visible until show().
+      @param  index  Zero indexed position of the LED on the strip.
+      @param  rgb  Color packed as 0x00RRGGBB.
+    */
+    virtual void set_pixel(uint16_t index, uint32_t rgb) = 0;
+
+    /*!
+      @brief  Push all pending pixel changes out to the LEDs.
+    */
+    virtual void show() = 0;
+
+    /*!
+      @brief  For sinks that keep the strip's bytes themselves: where they
+              are, so that colors can be packed straight in rather than
+              going through set_pixel() one at a time. Anything packed
+              there goes out on the next show(), same as set_pixel().
+      @return nullptr if there's nowhere to pack into.
+    */
+    virtual const Wire* get_wire() { return nullptr; }
+};
+
+}
@@ -0,0 +1,228 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/clock.hpp>
+#include <firefly/rng.hpp>
+#include <firefly/task.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  How fireflies come and go, in seconds. Ranges are half open,
+            like Species.
+*/
+struct Lifecycle {
+    // Time between one arrival and the next.
+    uint32_t arrival_min_s;
+    uint32_t arrival_max_s;
+    // How long a firefly stays out before it goes dormant or leaves.
+    uint32_t out_min_s;
+    uint32_t out_max_s;
+    // How long a dormant firefly stays dormant.
+    uint32_t dormant_min_s;
+    uint32_t dormant_max_s;
+    // Percent of fireflies that leave, rather than go dormant, when
+    // their time out is up.
+    uint8_t leave_pct;
+};
+
+namespace lifecycles {
+
+// A jar's worth of a summer field, sped up so it's worth watching: a
+// new firefly every five minutes or so, out for about forty, and a
+// third leave for good each time rather than resting for a while.
+inline constexpr Lifecycle summer = {
+    0, 600,
+    1200, 3600,
+    600, 1800,
+    33,
+};
+
+}
+
+
+/*!
+    @brief  Fireflies arriving, going dormant, waking up and leaving. The
+            jar's fireflies are a fixed pool, and the ones not in the jar
+            at the moment sit on a free list (a chain of indices, one per
+            firefly, kept here), so an arrival takes one off the front
+            and a departure puts one back: O(1), and nothing is ever
+            allocated. Dormant fireflies are held out of the jar like
+            absent ones, but aren't on the free list, so they come back
+            as themselves.
+
+            Run it as a background task. Each run looks at a few
+            fireflies in turn, so it costs the same however big the jar
+            is. Timings are in whole seconds, so nothing here needs to
+            happen more than about once a second per firefly.
+
+            Holding and releasing go through the jar, so don't use it on
+            the same jar as a Predator.
+    @tparam J  The jar.
+*/
+template <typename J>
+class Population : public Task {
+  private:
+    enum class Stage : uint8_t {
+        absent,
+        out,
+        dormant,
+    };
+
+    // Marks the end of the free list.
+    static constexpr uint16_t none = UINT16_MAX;
+
+    J& jar;
+    Clock& clock;
+    Rng& rng;
+    const Lifecycle& lifecycle;
+    uint16_t initial;
+
+    // What each firefly is doing, and until when (in seconds from
+    // Clock::now()).
+    Stage stages[J::size()];
+    uint32_t until[J::size()];
+
+    // The free list: free is the first absent firefly, next[i] the one
+    // after firefly i.
+    uint16_t next[J::size()];
+    uint16_t free;
+
+    uint32_t next_arrival;
+    // Whose turn it is to be looked at, and how many get looked at
+    // per run.
+    uint16_t cursor;
+    uint8_t batch;
+
+    uint32_t arrivals;
+    uint32_t departures;
+    uint16_t counts[3];
+
+    uint32_t seconds() { return this->clock.now() / 1000000; }
+
+    void set_stage(uint16_t index, Stage stage) {
+        this->counts[(uint8_t)this->stages[index]]--;
+        this->stages[index] = stage;
+        this->counts[(uint8_t)stage]++;
+    }
+
+    /*!
+      @brief Bring a firefly out, for a while.
+    */
+    void go_out(uint16_t index, uint32_t now) {
+        this->set_stage(index, Stage::out);
+        this->until[index] = now + this->rng.random(this->lifecycle.out_min_s, this->lifecycle.out_max_s);
+    }
+
+    /*!
+      @brief Take the first firefly off the free list and bring it out.
+      @return false if every firefly is already here.
+    */
+    bool spawn(uint32_t now) {
+        if (this->free == none) {
+            return false;
+        }
+        uint16_t index = this->free;
+        this->free = this->next[index];
+        this->jar.release(index);
+        this->go_out(index, now);
+        this->arrivals++;
+        return true;
+    }
+
+    /*!
+      @brief Take a firefly out of the jar and put it on the free list.
+    */
+    void retire(uint16_t index) {
+        this->jar.hold(index);
+        this->set_stage(index, Stage::absent);
+        this->next[index] = this->free;
+        this->free = index;
+        this->departures++;
+    }
+
+    /*!
+      @brief See whether one firefly's time is up.
+    */
+    void check(uint16_t index, uint32_t now) {
+        if (this->stages[index] == Stage::absent || now < this->until[index]) {
+            return;
+        }
+        if (this->stages[index] == Stage::dormant) {
+            this->jar.release(index);
+            this->go_out(index, now);
+        } else if (this->rng.random(0, 100) < this->lifecycle.leave_pct) {
+            this->retire(index);
+        } else {
+            this->jar.hold(index);
+            this->set_stage(index, Stage::dormant);
+            this->until[index] = now + this->rng.random(this->lifecycle.dormant_min_s, this->lifecycle.dormant_max_s);
+        }
+    }
+
+  public:
+    /*!
+      @param jar  Whose fireflies come and go.
+      @param clock  The jar's clock.
+      @param rng  Where the randomness comes from.
+      @param initial  How many fireflies are there to begin with.
+      @param lifecycle  How they come and go. Must outlive the population.
+      @param batch  How many fireflies to look at each run.
+    */
+    Population(J& jar, Clock& clock, Rng& rng, uint16_t initial,
+               const Lifecycle& lifecycle = lifecycles::summer, uint8_t batch = 4)
+        : jar(jar), clock(clock), rng(rng), lifecycle(lifecycle), free(none), next_arrival(0),
+          cursor(0), batch(batch), arrivals(0), departures(0) {
+        this->initial = initial > J::size() ? J::size() : initial;
+    }
+
+    /*!
+      @brief Send away everyone past the first `initial` fireflies. Call
+             after the jar's begin().
+    */
+    void begin() {
+        uint32_t now = this->seconds();
+        this->counts[(uint8_t)Stage::absent] = J::size();
+        this->counts[(uint8_t)Stage::out] = 0;
+        this->counts[(uint8_t)Stage::dormant] = 0;
+        this->free = none;
+
+        // Backwards, so the free list comes out in order.
+        for (size_t i = J::size(); i > 0; i--) {
+            uint16_t index = i - 1;
+            this->stages[index] = Stage::absent;
+            if (index < this->initial) {
+                this->go_out(index, now);
+            } else {
+                this->jar.hold(index);
+                this->next[index] = this->free;
+                this->free = index;
+            }
+        }
+        this->next_arrival = now + this->rng.random(this->lifecycle.arrival_min_s, this->lifecycle.arrival_max_s);
+    }
+
+    void run(uint32_t) override {
+        uint32_t now = this->seconds();
+
+        if (now >= this->next_arrival) {
+            this->spawn(now);
+            this->next_arrival = now + this->rng.random(this->lifecycle.arrival_min_s, this->lifecycle.arrival_max_s);
+        }
+
+        for (uint8_t i = 0; i < this->batch; i++) {
+            this->check(this->cursor, now);
+            this->cursor = this->cursor + 1 == J::size() ? 0 : this->cursor + 1;
+        }
+    }
+
+    uint16_t get_out() const { return this->counts[(uint8_t)Stage::out]; }
+    uint16_t get_dormant() const { return this->counts[(uint8_t)Stage::dormant]; }
+    uint16_t get_absent() const { return this->counts[(uint8_t)Stage::absent]; }
+    uint32_t get_arrivals() const { return this->arrivals; }
+    uint32_t get_departures() const { return this->departures; }
+};
+
+}
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/clock.hpp>
+#include <firefly/events.hpp>
+#include <firefly/rng.hpp>
+#include <firefly/species.hpp>
+#include <firefly/task.hpp>
+
+// How many males predators can be luring or digesting at once.
+#ifndef FIREFLY_MAX_CATCHES
+#define FIREFLY_MAX_CATCHES 8
+#endif
+
+namespace firefly {
+
+/*!
+    @brief  Predatory females hiding among a jar's own. They listen to
+            the same flashes as the jar's females and answer them just
+            like one would (with the jar's own female timing), but in
+            their own color. A male who's answered comes over a little
+            after, and some of the time gets eaten: he's held out of the
+            jar for a while, then let back in as if a new one had turned
+            up.
+
+            Run it as a background task so that lured males get caught
+            and eaten ones come back. It keeps a fixed table of catches,
+            so it never allocates; when the table is full, males get
+            away.
+    @tparam J  The jar. Needs set_courtship() called on it before
+            begin(), since the predators take over its first few
+            females.
+*/
+template <typename J>
+class Predator : public Listener, public Task {
+  private:
+    /*!
+        @brief  A male who's been answered and is on his way (until
+                `at`), or has been eaten (and comes back at `at`).
+    */
+    struct Catch {
+        uint16_t male;
+        bool eaten;
+        uint64_t at;
+    };
+
+    J& jar;
+    Clock& clock;
+    Rng& rng;
+    uint16_t count;
+    // Percent of lured males that get caught.
+    uint8_t appetite;
+    // How long an eaten male is out for, in milliseconds.
+    uint32_t digest_ms;
+
+    Catch catches[FIREFLY_MAX_CATCHES];
+    uint8_t catching;
+
+    uint32_t lures;
+    uint32_t eaten;
+
+  public:
+    /*!
+      @param jar  Whose females to hide among.
+      @param bus  The bus the jar publishes on.
+      @param clock  The jar's clock.
+      @param rng  Where the randomness comes from.
+      @param count  How many predators, taken from the jar's females.
+      @param appetite  Percent of lured males that get caught.
+      @param digest_ms  How long an eaten male is gone for.
+    */
+    Predator(J& jar, EventBus& bus, Clock& clock, Rng& rng, uint16_t count,
+             uint8_t appetite = 10, uint32_t digest_ms = 60000)
+        : jar(jar), clock(clock), rng(rng), count(count), appetite(appetite), digest_ms(digest_ms),
+          catching(0), lures(0), eaten(0) {
+        bus.subscribe(*this);
+    }
+
+    /*!
+      @brief Turn the predators into their own species (see
+             Jar::set_mimics()). Call after the jar's begin(). There
+             can't be more predators than the jar has females.
+    */
+    void begin(const Species& species = species::photuris) {
+        this->jar.set_mimics(species, this->count);
+        this->count = this->jar.get_mimics();
+    }
+
+    /*!
+      @brief A male flashed: have one predator (picked at random, so it's
+             one try whatever the count) answer him, and maybe go after
+             him.
+    */
+    void on_flash(const FlashEvent& event, uint64_t now) override {
+        if (!this->count) {
+            return;
+        }
+        // He can only be after one of them at a time.
+        for (uint8_t i = 0; i < this->catching; i++) {
+            if (this->catches[i].male == event.firefly) {
+                return;
+            }
+        }
+        uint16_t predator = this->rng.random(0, this->count);
+        if (!this->jar.answer(predator, event.time, now)) {
+            return;
+        }
+        this->lures++;
+        if (this->catching == FIREFLY_MAX_CATCHES || this->rng.random(0, 100) >= this->appetite) {
+            return;
+        }
+        // He turns up a second or so after her answer, which comes at
+        // most answer_max_ms after his flash.
+        uint64_t arrives = event.time + (this->jar.get_female_timing().answer_max_ms + 1000) * 1000ull;
+        this->catches[this->catching++] = {event.firefly, false, arrives};
+    }
+
+    /*!
+      @brief Catch any males that have turned up, and let out any that
+             have been digested.
+    */
+    void run(uint32_t) override {
+        uint64_t now = this->clock.now();
+        for (uint8_t i = 0; i < this->catching;) {
+            Catch& c = this->catches[i];
+            if (now < c.at) {
+                i++;
+            } else if (!c.eaten) {
+                this->jar.hold(c.male);
+                c.eaten = true;
+                c.at = now + this->digest_ms * 1000ull;
+                this->eaten++;
+                i++;
+            } else {
+                this->jar.release(c.male);
+                this->catches[i] = this->catches[--this->catching];
+            }
+        }
+    }
+
+    uint16_t get_count() const { return this->count; }
+    uint32_t get_lures() const { return this->lures; }
+    uint32_t get_eaten() const { return this->eaten; }
+};
+
+}
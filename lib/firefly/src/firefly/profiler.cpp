@@ -0,0 +1,51 @@
+#include <stdio.h>
+#include <string.h>
+
+#include <firefly/profiler.hpp>
+
+namespace firefly {
+
+static const char* const TIER_NAMES[TIERS] = {"realtime", "background"};
+
+
+void Profiler::reset() {
+    memset(this->tiers, 0, sizeof(this->tiers));
+}
+
+
+void Profiler::record(Tier tier, uint32_t latency, uint32_t run) {
+    TierStats& stats = this->tiers[(uint8_t)tier];
+    stats.runs++;
+    stats.latency_total += latency;
+    stats.run_total += run;
+    if (latency > stats.latency_max) {
+        stats.latency_max = latency;
+    }
+    if (run > stats.run_max) {
+        stats.run_max = run;
+    }
+}
+
+
+size_t Profiler::report(char* buffer, size_t size) const {
+    size_t used = 0;
+
+    for (uint8_t i = 0; i < TIERS && used < size; i++) {
+        const TierStats& stats = this->tiers[i];
+        uint32_t runs = stats.runs ? stats.runs : 1;
+        int written = snprintf(buffer + used, size - used,
+                               "%-10s runs %lu latency avg %lu max %lu us, run avg %lu max %lu us, overruns %lu\n",
+                               TIER_NAMES[i], (unsigned long)stats.runs,
+                               (unsigned long)(stats.latency_total / runs), (unsigned long)stats.latency_max,
+                               (unsigned long)(stats.run_total / runs), (unsigned long)stats.run_max,
+                               (unsigned long)stats.overruns);
+        if (written < 0) {
+            break;
+        }
+        used += written;
+    }
+
+    return used < size ? used : (size ? size - 1 : 0);
+}
+
+}
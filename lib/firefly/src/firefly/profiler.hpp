@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/task.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  Timing statistics for one tier of tasks. All in microseconds.
+*/
+struct TierStats {
+    uint32_t runs;
+    // How late a run started. For real-time tasks that's how long after
+    // its deadline; background tasks have no deadline, so it's how long
+    // since that same task last got to run.
+    uint32_t latency_max;
+    uint64_t latency_total;
+    // How long a run took.
+    uint32_t run_max;
+    uint64_t run_total;
+    // Real-time runs that started a whole period or more late.
+    uint32_t overruns;
+};
+
+
+/*!
+    @brief  Collects per-tier latency and run time from the Scheduler.
+            Recording is a handful of adds and compares, so it's always
+            on; reading it out is up to whoever wants the numbers.
+*/
+class Profiler {
+  private:
+    TierStats tiers[TIERS];
+
+  public:
+    Profiler() { this->reset(); }
+
+    void reset();
+    void record(Tier tier, uint32_t latency, uint32_t run);
+    void overrun(Tier tier) { this->tiers[(uint8_t)tier].overruns++; }
+
+    const TierStats& get(Tier tier) const { return this->tiers[(uint8_t)tier]; }
+
+    /*!
+      @brief  Write a human readable summary, one line per tier.
+      @param  buffer  Where to write it.
+      @param  size  Size of the buffer. The text is cut short if it doesn't fit.
+      @return Number of characters written, not counting the terminator.
+    */
+    size_t report(char* buffer, size_t size) const;
+};
+
+}
@@ -0,0 +1,73 @@
+#include <firefly/rng.hpp>
+
+namespace firefly {
+
+XorShiftRng::XorShiftRng(uint32_t seed) {
+    // Zero is the one state xorshift can never leave.
+    this->state = seed ? seed : 0x2545F491u;
+}
+
+
+uint32_t XorShiftRng::next() {
+    uint32_t x = this->state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    this->state = x;
+    return x;
+}
+
+
+void XorShiftRng::draw_many(const uint16_t*, const uint32_t*, size_t count, uint8_t slots, uint32_t* out) {
+    uint32_t x = this->state;
+    for (size_t n = count * slots; n > 0; n--) {
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        *out++ = x;
+    }
+    this->state = x;
+}
+
+
+void Rng::draw_many(const uint16_t* streams, const uint32_t* counters, size_t count, uint8_t slots, uint32_t* out) {
+    for (size_t i = 0; i < count; i++) {
+        for (uint8_t slot = 0; slot < slots; slot++) {
+            *out++ = this->draw(streams[i], counters[i], slot);
+        }
+    }
+}
+
+
+uint32_t Rng::random(uint32_t min, uint32_t max) {
+    if (max <= min) {
+        return min;
+    }
+    // Scale into the range with a multiply instead of a modulo.
+    // The bias is far below anything a firefly could show.
+    return min + (uint32_t)(((uint64_t)this->next() * (max - min)) >> 32);
+}
+
+
+PooledRng::PooledRng(Rng& source, uint8_t batch) : source(source), head(0), count(0), batch(batch) {}
+
+
+uint32_t PooledRng::next() {
+    if (this->count == 0) {
+        return this->source.next();
+    }
+    uint32_t value = this->pool[this->head];
+    this->head = (this->head + 1) % FIREFLY_RNG_POOL;
+    this->count--;
+    return value;
+}
+
+
+void PooledRng::run(uint32_t) {
+    for (uint8_t i = 0; i < this->batch && this->count < FIREFLY_RNG_POOL; i++) {
+        this->pool[(this->head + this->count) % FIREFLY_RNG_POOL] = this->source.next();
+        this->count++;
+    }
+}
+
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/task.hpp>
+
+// How many words of randomness a PooledRng keeps ready.
+#ifndef FIREFLY_RNG_POOL
+#define FIREFLY_RNG_POOL 32
+#endif
+
+namespace firefly {
+
+/*!
+    @brief  Source of randomness for the engine. On the ESP8266 this
+            is ESP8266TrueRandom, elsewhere it's a seeded generator so
+            runs can be repeated.
+*/
+class Rng {
+  public:
+    virtual ~Rng() = default;
+
+    /*!
+      @brief  Draw 32 random bits.
+    */
+    virtual uint32_t next() = 0;
+
+    /*!
+      @brief  Draw a random number.
+      @param  min  The lowest value that may be returned.
+      @param  max  One past the highest value that may be returned.
+      @return A value in [min, max).
+    */
+    uint32_t random(uint32_t min, uint32_t max);
+
+    /*!
+      @brief  Draw 32 random bits for something in particular: the
+              slot'th draw for the counter'th time round of stream (a
+              firefly's number and flash, say). Generators with state
+              just give the next() word. A CounterRng works the bits out
+              from these alone, so a draw comes out the same whatever
+              order everything draws in.
+    */
+    virtual uint32_t draw(uint16_t, uint32_t, uint8_t) { return this->next(); }
+
+    /*!
+      @brief  Many draws at once: out[i * slots + s] is what
+              draw(streams[i], counters[i], s) gives, made in that order,
+              so a stateful generator gives just what drawing them one at
+              a time would. Generators that can override it with a plain
+              loop, with no virtual call per draw (see Rolls).
+    */
+    virtual void draw_many(const uint16_t* streams, const uint32_t* counters, size_t count, uint8_t slots,
+                           uint32_t* out);
+
+    /*!
+      @brief  Write down where the generator has got to, in two words,
+              so that restore() carries on from exactly there (see
+              Jar::Checkpoint). Sources with nothing worth writing down,
+              like true randomness, leave zeros and ignore them again.
+    */
+    virtual void save(uint32_t (&state)[2]) const {
+        state[0] = 0;
+        state[1] = 0;
+    }
+    virtual void restore(const uint32_t (&)[2]) {}
+};
+
+
+/*!
+    @brief  One stream's draws for one time round, in order, as an Rng of
+            their own, so that whatever rolls from them needn't care
+            where they come from.
+*/
+class Draws : public Rng {
+  private:
+    Rng& rng;
+    uint16_t stream;
+    uint32_t counter;
+    uint8_t slot;
+
+  public:
+    Draws(Rng& rng, uint16_t stream, uint32_t counter, uint8_t slot = 0)
+        : rng(rng), stream(stream), counter(counter), slot(slot) {}
+
+    uint32_t next() override { return this->rng.draw(this->stream, this->counter, this->slot++); }
+};
+
+
+/*!
+    @brief  Small, fast, seeded generator (Marsaglia's xorshift32).
+            Good enough to make fireflies look random, and the same
+            seed always gives the same jar.
+*/
+class XorShiftRng : public Rng {
+  private:
+    uint32_t state;
+
+  public:
+    explicit XorShiftRng(uint32_t seed = 0x2545F491u);
+
+    uint32_t next() override;
+
+    // The streams make no difference, so this is just next() inlined.
+    void draw_many(const uint16_t*, const uint32_t*, size_t count, uint8_t slots, uint32_t* out) override;
+
+    void save(uint32_t (&state)[2]) const override {
+        state[0] = this->state;
+        state[1] = 0;
+    }
+
+    // A zero state would stay zero forever, so it's never restored.
+    void restore(const uint32_t (&state)[2]) override {
+        if (state[0]) {
+            this->state = state[0];
+        }
+    }
+};
+
+
+/*!
+    @brief  Randomness with no state to speak of: every draw is a hash of
+            the seed and what it's for (see Rng::draw()), so a firefly's
+            flashes come out the same however the loop happens to order
+            things, and nothing is kept per firefly. The hash is two
+            rounds of a 32 bit integer mixer (Chris Wellons' lowbias32),
+            which is cheap on the ESP8266, unlike 64 bit SplitMix or
+            Philox. Plain next() draws count along a stream of their own.
+*/
+class CounterRng : public Rng {
+  private:
+    uint32_t key;
+    uint32_t counter;
+
+    static uint32_t mix(uint32_t x) {
+        x ^= x >> 16;
+        x *= 0x7FEB352Du;
+        x ^= x >> 15;
+        x *= 0x846CA68Bu;
+        x ^= x >> 16;
+        return x;
+    }
+
+  public:
+    explicit CounterRng(uint32_t seed = 0x2545F491u) : key(mix(seed)), counter(0) {}
+
+    uint32_t next() override { return this->draw(UINT16_MAX, this->counter++, 0); }
+
+    uint32_t draw(uint16_t stream, uint32_t counter, uint8_t slot) override {
+        return mix(mix(this->key ^ ((uint32_t)stream << 8 | slot)) + counter * 0x9E3779B9u);
+    }
+
+    void draw_many(const uint16_t* streams, const uint32_t* counters, size_t count, uint8_t slots,
+                   uint32_t* out) override {
+        for (size_t i = 0; i < count; i++) {
+            uint32_t key = this->key ^ (uint32_t)streams[i] << 8;
+            uint32_t counter = counters[i] * 0x9E3779B9u;
+            for (uint8_t slot = 0; slot < slots; slot++) {
+                *out++ = mix(mix(key ^ slot) + counter);
+            }
+        }
+    }
+
+    void save(uint32_t (&state)[2]) const override {
+        state[0] = this->key;
+        state[1] = this->counter;
+    }
+
+    void restore(const uint32_t (&state)[2]) override {
+        this->key = state[0];
+        this->counter = state[1];
+    }
+};
+
+
+/*!
+    @brief  Keeps a small pool of random words from a slow source (like
+            the ESP8266's radio noise) so that drawing one on the hot
+            path is just a copy. The pool is topped up as a background
+            task. If it ever runs dry, draws go straight to the source,
+            which is slower but still right.
+*/
+class PooledRng : public Rng, public Task {
+  private:
+    Rng& source;
+    uint32_t pool[FIREFLY_RNG_POOL];
+    uint8_t head;
+    uint8_t count;
+    // Words added per run(), to keep each background slice short.
+    uint8_t batch;
+
+  public:
+    PooledRng(Rng& source, uint8_t batch = 4);
+
+    uint32_t next() override;
+
+    /*!
+      @brief  Top the pool up with at most a batch of words.
+    */
+    void run(uint32_t now) override;
+
+    uint8_t available() const { return this->count; }
+};
+
+}
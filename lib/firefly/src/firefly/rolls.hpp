@@ -0,0 +1,105 @@
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/config.hpp>
+#include <firefly/firefly.hpp>
+#include <firefly/rng.hpp>
+#include <firefly/species.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  Fireflies whose flashes have ended, waiting for their next
+            timings. Rather than each one rolling on its own the moment
+            its flash ends, a Jar gathers them here over a frame (see
+            Firefly::update(uint64_t)) and rolls for all of them at once.
+            Everything is kept as an array per field, so rolling is a
+            few straight loops: every draw in one call to the Rng (see
+            Rng::draw_many()), then each field's range reduction over
+            all of them, then the timings handed out.
+
+            The draws are made in the order one roll() after another
+            would make them, so the timings come out exactly the same,
+            even from a stateful Rng.
+    @tparam N  Most fireflies that can be waiting at once.
+*/
+template <size_t N>
+class Rolls {
+  private:
+    std::array<Firefly*, N> fireflies;
+    std::array<const Timing*, N> timings;
+    std::array<uint16_t, N> streams;
+    std::array<uint32_t, N> counters;
+    std::array<uint32_t, N * Firefly::ROLL_DRAWS> bits;
+
+    std::array<uint16_t, N> dark;
+    std::array<uint8_t, N> peak;
+    std::array<uint16_t, N> rising;
+    std::array<uint16_t, N> falling;
+    size_t count;
+
+    // Rng::random()'s multiply and shift, on a draw already made.
+    static uint32_t scale(uint32_t bits, uint32_t min, uint32_t max) {
+        return max <= min ? min : min + (uint32_t)(((uint64_t)bits * (max - min)) >> 32);
+    }
+
+    static uint16_t clamp16(uint32_t value) { return value > UINT16_MAX ? UINT16_MAX : value; }
+
+  public:
+    Rolls() : count(0) {}
+
+    /*!
+      @brief Have a firefly wait for its roll.
+      @param timing  The ranges to roll from. Must still be there when
+             roll() is called.
+    */
+    void add(Firefly& firefly, const Timing& timing) {
+        size_t k = this->count++;
+        this->fireflies[k] = &firefly;
+        this->timings[k] = &timing;
+        this->streams[k] = firefly.number;
+        this->counters[k] = firefly.get_rolls();
+    }
+
+    size_t size() const { return this->count; }
+    bool empty() const { return this->count == 0; }
+    bool full() const { return this->count == N; }
+    void clear() { this->count = 0; }
+
+    /*!
+      @brief Roll for every firefly waiting, as roll() would have, one
+             field at a time. clear() afterwards to start over.
+    */
+    FIREFLY_HOT_LOOP void roll(Rng& rng) {
+        const size_t n = this->count;
+        const uint8_t D = Firefly::ROLL_DRAWS;
+        const uint32_t* bits = this->bits.data();
+        rng.draw_many(this->streams.data(), this->counters.data(), n, D, this->bits.data());
+
+        for (size_t k = 0; k < n; k++) {
+            const Timing& timing = *this->timings[k];
+            this->dark[k] = scale(bits[k * D], timing.dark_min_ms, timing.dark_max_ms);
+        }
+        for (size_t k = 0; k < n; k++) {
+            const Species& species = this->fireflies[k]->get_species();
+            this->peak[k] = scale(bits[k * D + 1], species.peak_min, species.peak_max);
+        }
+        // The length is folded into the step delays, as in roll().
+        for (size_t k = 0; k < n; k++) {
+            const Timing& timing = *this->timings[k];
+            const Species& species = this->fireflies[k]->get_species();
+            uint32_t length = scale(bits[k * D + 2], species.length_min_pct, species.length_max_pct);
+            this->rising[k] = clamp16(scale(bits[k * D + 3], timing.rise_min_us, timing.rise_max_us) * length / 100);
+            this->falling[k] = clamp16(scale(bits[k * D + 4], timing.fall_min_us, timing.fall_max_us) * length / 100);
+        }
+
+        for (size_t k = 0; k < n; k++) {
+            this->fireflies[k]->set_roll(this->dark[k], this->peak[k], this->rising[k], this->falling[k]);
+        }
+    }
+};
+
+}
@@ -0,0 +1,86 @@
+#include <firefly/config.hpp>
+#include <firefly/scheduler.hpp>
+
+namespace firefly {
+
+Scheduler::Scheduler(Clock& clock, Profiler& profiler)
+    : clock(clock), profiler(profiler), count(0), cursor(0) {}
+
+
+bool Scheduler::add(Task& task, Tier tier, uint32_t period, FrameTicker* ticker) {
+    if (this->count == FIREFLY_MAX_TASKS) {
+        return false;
+    }
+    this->slots[this->count++] = {&task, tier, period, this->clock.micros(), ticker};
+    return true;
+}
+
+
+FIREFLY_HOT_LOOP void Scheduler::loop() {
+    uint32_t now = this->clock.micros();
+
+    // Real-time first. Anything due runs, and we work out how long
+    // we have until the next one is due while we're at it.
+    uint32_t slack = UINT32_MAX;
+    for (uint8_t i = 0; i < this->count; i++) {
+        Slot& slot = this->slots[i];
+        if (slot.tier != Tier::realtime) {
+            continue;
+        }
+
+        if (slot.ticker) {
+            // The timer decides when this is due. Expect the next tick
+            // a period after the last one, for working out the slack.
+            Tick tick;
+            if (slot.ticker->poll(tick)) {
+                uint32_t start = this->clock.micros();
+                slot.task->run(start);
+                now = this->clock.micros();
+                this->profiler.record(Tier::realtime, start - tick.time, now - start);
+            }
+            slot.mark = slot.ticker->get_last_time() + slot.period;
+        } else if ((int32_t)(now - slot.mark) >= 0) {
+            uint32_t start = this->clock.micros();
+            slot.task->run(start);
+            now = this->clock.micros();
+            this->profiler.record(Tier::realtime, start - slot.mark, now - start);
+
+            slot.mark += slot.period;
+            // If we've missed whole periods, don't try to make them all up,
+            // just start again from now.
+            if ((int32_t)(now - slot.mark) >= 0) {
+                this->profiler.overrun(Tier::realtime);
+                slot.mark = now + slot.period;
+            }
+        }
+
+        uint32_t left = slot.mark - now;
+        if ((int32_t)left < 0) {
+            left = 0;
+        }
+        if (left < slack) {
+            slack = left;
+        }
+    }
+
+    // Then at most one background task, if its slice fits in what's left.
+    for (uint8_t tries = 0; tries < this->count; tries++) {
+        Slot& slot = this->slots[this->cursor];
+        this->cursor = (this->cursor + 1) % this->count;
+        if (slot.tier != Tier::background) {
+            continue;
+        }
+        if (slot.period > slack) {
+            continue;
+        }
+
+        uint32_t start = this->clock.micros();
+        slot.task->run(start);
+        uint32_t end = this->clock.micros();
+        this->profiler.record(Tier::background, start - slot.mark, end - start);
+        slot.mark = end;
+        break;
+    }
+}
+
+}
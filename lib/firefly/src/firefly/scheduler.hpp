@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/clock.hpp>
+#include <firefly/profiler.hpp>
+#include <firefly/task.hpp>
+#include <firefly/ticker.hpp>
+
+// Most tasks a Scheduler can hold.
+#ifndef FIREFLY_MAX_TASKS
+#define FIREFLY_MAX_TASKS 10
+#endif
+
+namespace firefly {
+
+/*!
+    @brief  Runs tasks in two tiers. Real-time tasks have a period and
+            run as soon as they're due, before anything else. Background
+            tasks take turns, one per call to loop(), and only when the
+            slice of time they say they need fits before the next
+            real-time deadline. Nothing is ever preempted, so this is
+            only as good as the background tasks are at keeping their
+            slices short, but it means a slow console or a big telemetry
+            dump can never push a frame back by more than one slice.
+
+            A real-time task can also be driven by a FrameTicker instead of
+            its own period, in which case it runs once for every tick the
+            hardware timer posts.
+
+            AceRoutine's CoroutineScheduler just runs every coroutine in
+            turn, which is fine for the background tier (and on the
+            ESP8266 it can be put there as a single task), but it has no
+            idea that some of them can't wait.
+*/
+class Scheduler {
+  private:
+    struct Slot {
+        Task* task;
+        Tier tier;
+        // Real-time: time between runs. Background: the slice the task needs.
+        uint32_t period;
+        // Real-time: when it's next due. Background: when it last ran.
+        uint32_t mark;
+        // Real-time only: where ticks come from, if not the period.
+        FrameTicker* ticker;
+    };
+
+    Clock& clock;
+    Profiler& profiler;
+
+    Slot slots[FIREFLY_MAX_TASKS];
+    uint8_t count;
+    // Which background task gets the next turn.
+    uint8_t cursor;
+
+    bool add(Task& task, Tier tier, uint32_t period, FrameTicker* ticker = nullptr);
+
+  public:
+    Scheduler(Clock& clock, Profiler& profiler);
+
+    /*!
+      @brief  Add a task that must run every period microseconds.
+      @return false if the scheduler is full.
+    */
+    bool add_realtime(Task& task, uint32_t period_us) { return this->add(task, Tier::realtime, period_us); }
+
+    /*!
+      @brief  Add a task that must run every time the ticker ticks.
+      @return false if the scheduler is full.
+    */
+    bool add_realtime(Task& task, FrameTicker& ticker) {
+        return this->add(task, Tier::realtime, ticker.get_period(), &ticker);
+    }
+
+    /*!
+      @brief  Add a task that runs whenever there's time to spare.
+      @param  slice_us  How long one run of the task takes at most.
+      @return false if the scheduler is full.
+    */
+    bool add_background(Task& task, uint32_t slice_us) { return this->add(task, Tier::background, slice_us); }
+
+    /*!
+      @brief  Run whatever is due. Call this from the main loop.
+    */
+    void loop();
+};
+
+}
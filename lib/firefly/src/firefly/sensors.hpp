@@ -0,0 +1,257 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/task.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  A thermometer. Reading one can take a while (a DS18B20 needs
+            most of a second per conversion), so nothing here ever
+            waits: request() starts a reading, and poll() says whether
+            it's done yet.
+*/
+class TemperatureSensor {
+  public:
+    virtual ~TemperatureSensor() = default;
+
+    /*!
+      @brief  Start taking a reading.
+    */
+    virtual void request() = 0;
+
+    /*!
+      @brief  Check on the reading started by request().
+      @param  decicelsius  Set to the temperature, in tenths of a degree
+              Celsius, once it's ready.
+      @return true once the reading is ready (and only once per request).
+    */
+    virtual bool poll(int16_t& decicelsius) = 0;
+};
+
+
+/*!
+    @brief  A thermometer that says whatever it's told to. For the
+            simulator, and for jars without a sensor.
+*/
+class FixedTemperature : public TemperatureSensor {
+  private:
+    int16_t value;
+    bool pending;
+
+  public:
+    explicit FixedTemperature(int16_t decicelsius) : value(decicelsius), pending(false) {}
+
+    void set(int16_t decicelsius) { this->value = decicelsius; }
+
+    void request() override { this->pending = true; }
+
+    bool poll(int16_t& decicelsius) override {
+        if (!this->pending) {
+            return false;
+        }
+        this->pending = false;
+        decicelsius = this->value;
+        return true;
+    }
+};
+
+
+/*!
+    @brief  Reads a thermometer every so often and passes the result on,
+            as a background task. Each run does at most one step of the
+            read, so it never holds anything up.
+    @tparam Target  Anything with set_temperature(int16_t), such as a Jar.
+*/
+template <typename Target>
+class TemperatureTask : public Task {
+  private:
+    TemperatureSensor& sensor;
+    Target& target;
+    uint32_t period;
+    uint32_t last;
+    bool started;
+    bool pending;
+
+  public:
+    /*!
+      @param sensor  Where readings come from.
+      @param target  Where they go.
+      @param period_us  How often to take a reading. Temperature doesn't
+             change fast, so a minute is plenty.
+    */
+    TemperatureTask(TemperatureSensor& sensor, Target& target, uint32_t period_us = 60000000)
+        : sensor(sensor), target(target), period(period_us), last(0), started(false), pending(false) {}
+
+    void run(uint32_t now) override {
+        if (this->pending) {
+            int16_t value;
+            if (this->sensor.poll(value)) {
+                this->pending = false;
+                this->target.set_temperature(value);
+                return;
+            }
+            // A reading that never comes (the sensor was unplugged, say)
+            // is given up on once the next one is due.
+            if (now - this->last < this->period) {
+                return;
+            }
+        } else if (this->started && now - this->last < this->period) {
+            return;
+        }
+        this->started = true;
+        this->last = now;
+        this->pending = true;
+        this->sensor.request();
+    }
+};
+
+
+
+/*!
+    @brief  Something that says how light the room is, like a
+            photoresistor on an ADC. Reading one only takes a moment,
+            so unlike a thermometer it's read in one go.
+*/
+class LightSensor {
+  public:
+    virtual ~LightSensor() = default;
+
+    /*!
+      @return How light it is, from 0 (pitch dark) to 1023 (as light as
+              the sensor can tell).
+    */
+    virtual uint16_t read() = 0;
+};
+
+
+/*!
+    @brief  A light sensor that says whatever it's told to. For the
+            simulator, and for jars without a sensor.
+*/
+class FixedLight : public LightSensor {
+  private:
+    uint16_t value;
+
+  public:
+    explicit FixedLight(uint16_t level) : value(level) {}
+
+    void set(uint16_t level) { this->value = level; }
+
+    uint16_t read() override { return this->value; }
+};
+
+
+/*!
+    @brief  How a jar should react to the light in the room, in the
+            sensor's 0-1023 units. Below dark, the jar runs at
+            min_brightness; above bright, at full; in between, somewhere
+            in between. Above pause it's daytime and the jar stops
+            altogether, until it's back below resume.
+*/
+struct LightCurve {
+    uint16_t dark;
+    uint16_t bright;
+    uint16_t pause;
+    uint16_t resume;
+    uint8_t min_brightness;
+
+    /*!
+      @return The global brightness for a light level, 255 for full.
+    */
+    constexpr uint8_t brightness(uint16_t level) const {
+        return level <= this->dark     ? this->min_brightness
+             : level >= this->bright   ? 255
+             : this->min_brightness + (uint32_t)(255 - this->min_brightness)
+                                    * (level - this->dark) / (this->bright - this->dark);
+    }
+};
+
+namespace curves {
+
+// A jar on a desk: dim in a dark room, full brightness under the lights,
+// off in daylight. A pause of 1024 or more never pauses.
+inline constexpr LightCurve desk = {50, 600, 900, 800, 48};
+
+}
+
+
+/*!
+    @brief  Reads a light sensor every so often, smooths it out and sets
+            the jar's brightness to match, as a background task. Each
+            run does at most one reading.
+
+            The smoothing is a running average over roughly the last
+            eight readings, so a shadow passing over doesn't make the
+            jar flicker, and the pause has hysteresis so a jar sitting
+            right at the threshold doesn't keep stopping and starting.
+    @tparam Target  Anything with set_brightness(uint8_t) and
+            set_paused(bool), such as a Jar.
+*/
+template <typename Target>
+class LightTask : public Task {
+  private:
+    LightSensor& sensor;
+    Target& target;
+    const LightCurve& curve;
+    uint32_t period;
+    uint32_t last;
+    bool started;
+
+    // The smoothed level, with 4 extra bits so small steps aren't lost.
+    uint16_t filtered;
+    uint8_t brightness;
+    bool paused;
+
+  public:
+    /*!
+      @param sensor  Where readings come from.
+      @param target  Where they go.
+      @param curve  How to turn a light level into a brightness. Must
+             outlive the task.
+      @param period_us  How often to take a reading.
+    */
+    LightTask(LightSensor& sensor, Target& target, const LightCurve& curve = curves::desk,
+              uint32_t period_us = 250000)
+        : sensor(sensor), target(target), curve(curve), period(period_us), last(0),
+          started(false), filtered(0), brightness(255), paused(false) {}
+
+    void run(uint32_t now) override {
+        if (this->started && now - this->last < this->period) {
+            return;
+        }
+        this->last = now;
+
+        uint16_t reading = this->sensor.read() << 4;
+        if (!this->started) {
+            // Start from the first reading rather than creeping up from 0.
+            this->started = true;
+            this->filtered = reading;
+        } else {
+            this->filtered += ((int32_t)reading - this->filtered) / 8;
+        }
+
+        uint16_t level = this->get_level();
+        bool paused = this->paused ? level > this->curve.resume : level >= this->curve.pause;
+        if (paused != this->paused) {
+            this->paused = paused;
+            this->target.set_paused(paused);
+        }
+
+        uint8_t brightness = this->curve.brightness(level);
+        if (brightness != this->brightness) {
+            this->brightness = brightness;
+            this->target.set_brightness(brightness);
+        }
+    }
+
+    /*!
+      @return The smoothed light level, 0 to 1023.
+    */
+    uint16_t get_level() const { return (this->filtered + 8) >> 4; }
+    uint8_t get_brightness() const { return this->brightness; }
+    bool is_paused() const { return this->paused; }
+};
+
+}
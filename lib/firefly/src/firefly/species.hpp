@@ -0,0 +1,157 @@
+#pragma once
+
+#include <stdint.h>
+
+#include <firefly/color.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  Everything that makes one kind of firefly look different
+            from another: how long it stays dark between flashes, how
+            fast it brightens and fades, how bright it gets, and what
+            color it glows. The rise and fall are made of one brightness
+            step per level up to the flash's peak, so the step delays
+            are per step, not for the whole ramp.
+            Every range is half open, [min, max), the same as
+            ESP8266TrueRandom.random().
+*/
+struct Species {
+    const char* name;
+
+    // Dark time between two flashes, in milliseconds.
+    uint16_t dark_min_ms;
+    uint16_t dark_max_ms;
+
+    // Delay between brightness steps while rising, in microseconds.
+    uint16_t rise_min_us;
+    uint16_t rise_max_us;
+
+    // Delay between brightness steps while falling, in microseconds.
+    uint16_t fall_min_us;
+    uint16_t fall_max_us;
+
+    // How bright a flash gets at its peak, up to 255 (so peak_max up to
+    // 256). peak_min has to be at least 1.
+    uint16_t peak_min;
+    uint16_t peak_max;
+
+    // How much longer or shorter a flash is than its step delays alone
+    // would make it, in percent. Both the rise and the fall of a flash
+    // get the same one, so a long flash is long all the way through.
+    uint8_t length_min_pct;
+    uint8_t length_max_pct;
+
+    // How long after a male's flash starts a female answers it, in
+    // milliseconds.
+    uint16_t answer_min_ms;
+    uint16_t answer_max_ms;
+
+    // Its color at every brightness, usually emission<nm> for the
+    // wavelength it glows at.
+    const ColorTable* colors;
+
+    // The temperature the timings above are for, in tenths of a degree
+    // Celsius, and how much faster (in percent) everything gets for each
+    // degree warmer than that. Colder slows it down the same way.
+    int16_t reference_decicelsius;
+    uint8_t percent_per_degree;
+
+    /*!
+      @brief  How much longer (or shorter) every interval is at the given
+              temperature, from this species' rate curve.
+      @param  decicelsius  Temperature in tenths of a degree Celsius.
+      @return Scale for all intervals, 256 meaning unchanged. Held
+              between 128 and 512, since past that the firefly
+              wouldn't be out at all.
+    */
+    uint16_t interval_scale(int16_t decicelsius) const {
+        // Flash rate is 100% + percent_per_degree for each degree above
+        // the reference, and intervals are its inverse.
+        int32_t rate = 1000 + (int32_t)this->percent_per_degree * (decicelsius - this->reference_decicelsius);
+        if (rate < 500) {
+            return 512;
+        }
+        int32_t scale = 256 * 1000 / rate;
+        return scale < 128 ? 128 : scale;
+    }
+
+    /*!
+      @brief  Color of this species at the given brightness.
+      @param  brightness  The brightness value from 0 to 255.
+      @return uint32_t color value packed as 0x00RRGGBB.
+    */
+    uint32_t color(uint8_t brightness) const {
+        return (*this->colors)[brightness];
+    }
+};
+
+
+/*!
+    @brief  The ranges a firefly actually rolls its timings from. They
+            start out as the species' own, and the jar rescales them all
+            at once whenever something that affects them changes (how
+            far into the night it is, say), so that rolling a flash is
+            only ever a lookup. Ranges are half open, like Species.
+*/
+struct Timing {
+    uint16_t dark_min_ms;
+    uint16_t dark_max_ms;
+    uint16_t rise_min_us;
+    uint16_t rise_max_us;
+    uint16_t fall_min_us;
+    uint16_t fall_max_us;
+    uint16_t answer_min_ms;
+    uint16_t answer_max_ms;
+
+    /*!
+      @brief  The timings of a species, unchanged.
+    */
+    static constexpr Timing of(const Species& species) {
+        return {species.dark_min_ms, species.dark_max_ms,
+                species.rise_min_us, species.rise_max_us,
+                species.fall_min_us, species.fall_max_us,
+                species.answer_min_ms, species.answer_max_ms};
+    }
+};
+
+
+namespace species {
+
+// Photinus Pyralis, the Common Eastern Firefly. The timings are the
+// ones the jar has always used, taken as a warm June evening (24 C).
+// Flashes reach anywhere from 60% to full brightness, and run 15% either
+// side of their usual length. Females answer about two seconds after a
+// male flashes. The color peaks at about 562 nm.
+inline constexpr Species p_pyralis = {
+    "Photinus pyralis",
+    4000, 7000,
+    1000, 1300,
+    1500, 2000,
+    160, 256,
+    85, 116,
+    1900, 2400,
+    &emission<562>,
+    240, 4,
+};
+
+// Photuris versicolor, the "femme fatale". Females of this genus answer
+// P. Pyralis males with P. Pyralis' own female answer, then eat whoever
+// turns up. Their own flashes are longer and slower, and a greener
+// 552 nm or so. Hidden among another jar's females (see
+// Jar::set_mimics()) they answer on that jar's timing, not this one.
+inline constexpr Species photuris = {
+    "Photuris versicolor",
+    2000, 4000,
+    1500, 2000,
+    2000, 3000,
+    200, 256,
+    90, 111,
+    1900, 2400,
+    &emission<552>,
+    240, 4,
+};
+
+}
+
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/config.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  A fixed size queue for exactly one producer and one consumer,
+            for example an interrupt handler and the main loop. Neither
+            side ever waits or disables interrupts: the producer only
+            ever writes the tail, the consumer only ever writes the head,
+            and each reads the other's with acquire ordering.
+    @tparam T  What's queued. Copied in and out, so keep it small.
+    @tparam Capacity  How many items fit. Must be a power of two.
+*/
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0,
+                  "SpscQueue capacity must be a power of two");
+
+  private:
+    T items[Capacity];
+    // Both of these only ever count up; the index is the count modulo
+    // the capacity, and tail - head is how many items are queued.
+    std::atomic<uint32_t> head;
+    std::atomic<uint32_t> tail;
+
+  public:
+    SpscQueue() : head(0), tail(0) {}
+
+    /*!
+      @brief  Add an item. Producer side only. Safe to call from an
+              interrupt handler that's FIREFLY_ISR itself, which gets
+              its own copy (see FIREFLY_INLINE).
+      @return false if the queue was full, in which case nothing changed.
+    */
+    FIREFLY_INLINE bool push(const T& item) {
+        uint32_t tail = this->tail.load(std::memory_order_relaxed);
+        if (tail - this->head.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        this->items[tail % Capacity] = item;
+        this->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+      @brief  Take the oldest item. Consumer side only.
+      @return false if the queue was empty.
+    */
+    bool pop(T& item) {
+        uint32_t head = this->head.load(std::memory_order_relaxed);
+        if (head == this->tail.load(std::memory_order_acquire)) {
+            return false;
+        }
+        item = this->items[head % Capacity];
+        this->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /*!
+      @brief  How many items are queued. Only a snapshot if the other
+              side is busy at the same time.
+    */
+    size_t size() const {
+        return this->tail.load(std::memory_order_acquire) - this->head.load(std::memory_order_acquire);
+    }
+};
+
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <array>
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/clock.hpp>
+#include <firefly/compositor.hpp>
+#include <firefly/config.hpp>
+#include <firefly/firefly.hpp>
+#include <firefly/output.hpp>
+#include <firefly/rng.hpp>
+#include <firefly/species.hpp>
+#include <firefly/task.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  Fireflies that fly. Real ones don't hold still while they
+            flash (P. Pyralis draws its "J" mid-air), so here each one
+            drifts along the strip for the length of a flash, at its own
+            speed and direction, and picks up where it left off for the
+            next. Where it is doesn't have to be on an LED: its light is
+            split between the LEDs either side (see Canvas), so it glides
+            rather than hops.
+
+            There needn't be as many fireflies as LEDs. Everything else
+            works the same as a Jar: give it to a Scheduler as a
+            real-time task.
+    @tparam N  Number of LEDs.
+    @tparam M  Number of fireflies.
+    @tparam S  Species of every firefly.
+*/
+template <size_t N, size_t M, const Species& S = species::p_pyralis>
+class Swarm : public Task {
+  public:
+    // How long one frame takes to go out over the wire, and how long
+    // it's allowed to take. Same as for a Jar.
+    static constexpr uint32_t wire_us = N * FIREFLY_WIRE_US_PER_LED + FIREFLY_WIRE_LATCH_US;
+    static constexpr uint32_t frame_budget_us =
+        FIREFLY_FRAME_BUDGET_US ? FIREFLY_FRAME_BUDGET_US : S.rise_min_us;
+
+    // The end of the strip, as a position.
+    static constexpr int32_t end = (int32_t)(N - 1) << 16;
+
+  private:
+    /*!
+        @brief  Where a firefly is going. Positions are in 1/65536ths of
+                an LED, and speeds in 1/65536ths of an LED every 1024 us,
+                so working out where a firefly has got to is a shift and
+                a multiply.
+    */
+    struct Flight {
+        int32_t origin;
+        int16_t velocity;
+        Phase phase;
+        // When the flash started. Flashes are short, so 32 bits do.
+        uint32_t start;
+    };
+
+    Clock& clock;
+    Rng& rng;
+    Compositor<N> compositor;
+    Canvas<N> canvas;
+
+    std::array<Firefly, M> fireflies;
+    std::array<Flight, M> flights;
+    Timing timing;
+
+    // Fastest a firefly flies, in 1/256ths of an LED per second.
+    uint16_t max_speed;
+
+    /*!
+      @brief Where a firefly is, `elapsed` microseconds into its flash.
+             It bounces off either end of the strip, as many times as it
+             takes: after a long stall it's still somewhere it could
+             have flown to, not stuck at an end.
+    */
+    static int32_t where(const Flight& flight, uint32_t elapsed) {
+        // Worked out in 64 bits, since on a long strip twice its length
+        // doesn't fit in 32, and neither does a long stall at speed.
+        // Flying there and back is one lap; only how far into the lap
+        // it's got matters. A flash is over well within a lap, so the
+        // division is almost never needed.
+        const int64_t lap = 2 * (int64_t)end;
+        int64_t position = flight.origin + (int64_t)flight.velocity * (elapsed >> 10);
+        if (position < 0 || position >= lap) {
+            position %= lap;
+            if (position < 0) {
+                position += lap;
+            }
+        }
+        return position > end ? lap - position : position;
+    }
+
+    /*!
+      @brief Pick a speed and direction for the next flash. Only done
+             once a flash, so the division doesn't matter.
+    */
+    int16_t roll_velocity() {
+        int32_t speed = this->rng.random(0, 2 * this->max_speed + 1) - this->max_speed;
+        // 1/256ths of an LED a second, to 1/65536ths every 1024 us.
+        return (int64_t)speed * 256 * 1024 / 1000000;
+    }
+
+  public:
+    /*!
+      @param max_speed  Fastest a firefly flies, in 1/256ths of an LED
+             per second. The default is two LEDs a second, which on fairy
+             lights with LEDs every 10 cm is about what a real one does.
+    */
+    Swarm(OutputSink& sink, Clock& clock, Rng& rng, uint16_t max_speed = 512)
+        : clock(clock), rng(rng), compositor(sink), timing(Timing::of(S)), max_speed(max_speed) {
+        static_assert(N > 1, "Fireflies need at least two LEDs to fly between");
+        static_assert(N <= INT16_MAX, "Positions are 16.16 fixed point");
+        static_assert(M > 0, "A swarm needs at least one firefly");
+        // The strip keeps 3 bytes per LED of its own on top of the
+        // swarm, and there's the species' color table as well.
+        static_assert(sizeof(Swarm) + 3 * N + sizeof(ColorTable) <= FIREFLY_RAM_BUDGET,
+                      "Swarm does not fit FIREFLY_RAM_BUDGET, use fewer LEDs or fireflies");
+        static_assert(wire_us <= frame_budget_us,
+                      "Showing this many LEDs takes longer than a brightness step, "
+                      "use fewer LEDs or raise FIREFLY_FRAME_BUDGET_US");
+    }
+
+    /*!
+      @brief Turn every LED off and scatter the fireflies along the strip,
+             each at its own point of its cycle, as in a Jar.
+    */
+    void begin() {
+        uint64_t now = this->clock.now();
+
+        for (size_t i = 0; i < M; i++) {
+            this->fireflies[i] = Firefly(i, S);
+            this->fireflies[i].warm(now, this->rng, this->timing);
+            Flight& flight = this->flights[i];
+            flight.origin = this->rng.random(0, N - 1) << 16 | (this->rng.next() & 0xFFFF);
+            flight.velocity = this->roll_velocity();
+            flight.phase = this->fireflies[i].get_phase();
+            flight.start = now;
+        }
+        this->compositor.clear();
+        this->compositor.show();
+        this->canvas.invalidate();
+    }
+
+    /*!
+      @brief Scale the brightness of the whole swarm. See Jar.
+    */
+    void set_brightness(uint8_t brightness) {
+        this->compositor.set_brightness(brightness);
+        this->canvas.invalidate();
+    }
+
+    /*!
+      @brief Have LEDs fade out over a few tens of milliseconds at the
+             end of a flash, instead of cutting off. See Compositor.
+      @param time_constant_ms  0 turns it off.
+    */
+    void set_afterglow(uint16_t time_constant_ms) { this->compositor.set_afterglow(time_constant_ms); }
+
+    /*!
+      @brief Bring every firefly up to the current time, move it, and
+             show the result.
+    */
+    FIREFLY_HOT_LOOP void update() {
+        uint64_t now = this->clock.now();
+
+        for (size_t i = 0; i < M; i++) {
+            Firefly& firefly = this->fireflies[i];
+            Flight& flight = this->flights[i];
+            firefly.update(now, this->rng, this->timing);
+
+            Phase phase = firefly.get_phase();
+            if (phase != flight.phase) {
+                if (phase == Phase::rising) {
+                    flight.start = now;
+                    flight.velocity = this->roll_velocity();
+                } else if (phase == Phase::dark) {
+                    // Rest where the flash ended.
+                    flight.origin = where(flight, (uint32_t)now - flight.start);
+                }
+                flight.phase = phase;
+            }
+
+            uint8_t brightness = firefly.get_brightness();
+            if (brightness && firefly.is_visible()) {
+                int32_t position = where(flight, (uint32_t)now - flight.start);
+                this->canvas.add(position >> 8, brightness);
+            }
+        }
+
+        this->canvas.draw(this->compositor, S);
+        this->compositor.show(now);
+    }
+
+    void run(uint32_t) override { this->update(); }
+
+    const Firefly& operator[](size_t index) const { return this->fireflies[index]; }
+
+    /*!
+      @return Where a firefly is right now, in 1/65536ths of an LED.
+    */
+    int32_t get_position(size_t index) const {
+        const Flight& flight = this->flights[index];
+        if (flight.phase == Phase::dark) {
+            return flight.origin;
+        }
+        return where(flight, (uint32_t)this->clock.now() - flight.start);
+    }
+
+    const std::array<uint32_t, N>& get_frame() const { return this->compositor.get_frame(); }
+};
+
+}
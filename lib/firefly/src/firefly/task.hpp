@@ -0,0 +1,38 @@
+#pragma once
+
+#include <stdint.h>
+
+namespace firefly {
+
+/*!
+    @brief  Something the Scheduler runs. A task should do a small,
+            bounded piece of work each time it's run and then return;
+            nothing ever interrupts it.
+*/
+class Task {
+  public:
+    virtual ~Task() = default;
+
+    /*!
+      @brief  Do one slice of work.
+      @param  now  The time the scheduler started this run, in microseconds.
+    */
+    virtual void run(uint32_t now) = 0;
+};
+
+
+/*!
+    @brief  How urgent a task is. Real-time tasks (rendering and
+            showing a frame) run on a fixed period and always come
+            first. Background tasks (refilling randomness, draining
+            telemetry, the console) only get the time left over.
+*/
+enum class Tier : uint8_t {
+    realtime,
+    background,
+};
+
+// Number of tiers, for sizing per-tier arrays.
+static const uint8_t TIERS = 2;
+
+}
@@ -0,0 +1,52 @@
+#include <string.h>
+
+#include <firefly/telemetry.hpp>
+
+namespace firefly {
+
+Telemetry::Telemetry(TextSink& sink, size_t batch)
+    : sink(sink), head(0), count(0), dropped(0), batch(batch) {}
+
+
+size_t Telemetry::write(const char* text, size_t length) {
+    size_t room = FIREFLY_TELEMETRY_BUFFER - this->count;
+    if (length > room) {
+        this->dropped += length - room;
+        length = room;
+    }
+    for (size_t i = 0; i < length; i++) {
+        this->buffer[(this->head + this->count + i) % FIREFLY_TELEMETRY_BUFFER] = text[i];
+    }
+    this->count += length;
+    return length;
+}
+
+
+size_t Telemetry::write(const char* text) {
+    return this->write(text, strlen(text));
+}
+
+
+void Telemetry::run(uint32_t) {
+    size_t budget = this->batch;
+    while (this->count && budget) {
+        // Only hand over the part that doesn't wrap around.
+        size_t length = FIREFLY_TELEMETRY_BUFFER - this->head;
+        if (length > this->count) {
+            length = this->count;
+        }
+        if (length > budget) {
+            length = budget;
+        }
+
+        size_t taken = this->sink.write(this->buffer + this->head, length);
+        this->head = (this->head + taken) % FIREFLY_TELEMETRY_BUFFER;
+        this->count -= taken;
+        budget -= taken;
+        if (taken < length) {
+            break;
+        }
+    }
+}
+
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <firefly/task.hpp>
+
+// Bytes of telemetry that can be waiting to go out.
+#ifndef FIREFLY_TELEMETRY_BUFFER
+#define FIREFLY_TELEMETRY_BUFFER 512
+#endif
+
+namespace firefly {
+
+/*!
+    @brief  Where telemetry text ends up: the serial port on the
+            ESP8266, stdout in the simulator.
+*/
+class TextSink {
+  public:
+    virtual ~TextSink() = default;
+
+    /*!
+      @brief  Write as much of the text as can go out without waiting.
+      @return How many characters were taken.
+    */
+    virtual size_t write(const char* text, size_t length) = 0;
+};
+
+
+/*!
+    @brief  A ring buffer of text that anything can write into without
+            blocking, drained to a TextSink a little at a time as a
+            background task. When the buffer is full, new text is
+            dropped rather than waited on.
+*/
+class Telemetry : public Task {
+  private:
+    TextSink& sink;
+    char buffer[FIREFLY_TELEMETRY_BUFFER];
+    size_t head;
+    size_t count;
+    size_t dropped;
+    // Most characters handed to the sink per run().
+    size_t batch;
+
+  public:
+    Telemetry(TextSink& sink, size_t batch = 64);
+
+    /*!
+      @brief  Queue some text. Whatever doesn't fit is dropped.
+      @return How many characters were queued.
+    */
+    size_t write(const char* text, size_t length);
+    size_t write(const char* text);
+
+    /*!
+      @brief  Hand up to a batch of characters to the sink.
+    */
+    void run(uint32_t now) override;
+
+    size_t pending() const { return this->count; }
+    size_t get_dropped() const { return this->dropped; }
+};
+
+}
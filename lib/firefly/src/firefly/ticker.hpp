@@ -0,0 +1,89 @@
+#pragma once
+
+#include <atomic>
+#include <stdint.h>
+
+#include <firefly/config.hpp>
+#include <firefly/spsc_queue.hpp>
+
+namespace firefly {
+
+/*!
+    @brief  One frame tick: which one it was, and when it fired.
+*/
+struct Tick {
+    uint32_t sequence;
+    uint32_t time;
+};
+
+
+/*!
+    @brief  Hands frame ticks from a hardware timer to the main loop.
+            The timer's interrupt calls tick(), which posts to a lock
+            free queue; the Scheduler polls it and renders a frame for
+            each tick it finds. That way when a frame starts is decided
+            by the timer, not by how long the last trip around loop()
+            took. If the loop falls behind, queued ticks are collapsed
+            into the newest one and counted as missed, since drawing a
+            stale frame would only make it later.
+*/
+class FrameTicker {
+  private:
+    SpscQueue<Tick, 8> queue;
+    uint32_t period;
+
+    // Written by the interrupt only.
+    uint32_t sequence;
+    std::atomic<uint32_t> dropped;
+
+    // Written by the main loop only.
+    uint32_t missed;
+    uint32_t last_time;
+
+  public:
+    explicit FrameTicker(uint32_t period_us)
+        : period(period_us), sequence(0), dropped(0), missed(0), last_time(0) {}
+
+    /*!
+      @brief  Post a tick. Call this from the timer interrupt (or, on the
+              host, whatever thread stands in for it).
+      @param  now  The time the timer fired, in microseconds.
+    */
+    FIREFLY_ISR void tick(uint32_t now) {
+        if (!this->queue.push({this->sequence, now})) {
+            this->dropped.store(this->dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        }
+        this->sequence++;
+    }
+
+    /*!
+      @brief  Take the newest tick, if there is one. Main loop only.
+      @param  latest  Set to the newest tick.
+      @return false if no tick has fired since the last poll.
+    */
+    bool poll(Tick& latest) {
+        if (!this->queue.pop(latest)) {
+            return false;
+        }
+        Tick newer;
+        while (this->queue.pop(newer)) {
+            latest = newer;
+            this->missed++;
+        }
+        this->last_time = latest.time;
+        return true;
+    }
+
+    uint32_t get_period() const { return this->period; }
+
+    // When the last tick that was polled fired.
+    uint32_t get_last_time() const { return this->last_time; }
+
+    // Ticks that were collapsed into a newer one by poll().
+    uint32_t get_missed() const { return this->missed; }
+
+    // Ticks that didn't fit in the queue at all.
+    uint32_t get_dropped() const { return this->dropped.load(std::memory_order_relaxed); }
+};
+
+}
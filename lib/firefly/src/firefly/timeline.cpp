@@ -0,0 +1,89 @@
+#include <firefly/timeline.hpp>
+
+namespace firefly {
+
+uint8_t Timeline::activity_at(uint64_t since_dusk) const {
+    if (this->count == 0) {
+        return 255;
+    }
+
+    // Work in seconds into the day, which is plenty fine grained and
+    // keeps everything below in 32 bits.
+    uint32_t second = (since_dusk / 1000000) % ((uint64_t)this->day_minutes * 60);
+
+    for (size_t i = 1; i < this->count; i++) {
+        const Keyframe& next = this->keyframes[i];
+        uint32_t end = (uint32_t)next.minute * 60;
+        if (second < end) {
+            const Keyframe& last = this->keyframes[i - 1];
+            uint32_t start = (uint32_t)last.minute * 60;
+            int32_t span = next.activity - last.activity;
+            return last.activity + span * (int32_t)(second - start) / (int32_t)(end - start);
+        }
+    }
+    return this->keyframes[this->count - 1].activity;
+}
+
+
+
+uint64_t Timeline::until_active(uint64_t since_dusk) const {
+    if (this->count == 0) {
+        return 0;
+    }
+
+    uint32_t day = this->day_minutes * 60;
+    uint32_t second = (since_dusk / 1000000) % day;
+
+    // Later today, or else some time tomorrow.
+    uint32_t from = second;
+    for (uint32_t days = 0; days < 2; days++) {
+        uint32_t found = this->first_active(from);
+        if (found != UINT32_MAX) {
+            uint64_t seconds = (uint64_t)days * day + found - second;
+            return seconds ? seconds * 1000000 - since_dusk % 1000000 : 0;
+        }
+        from = 0;
+    }
+    return UINT64_MAX;
+}
+
+
+uint32_t Timeline::first_active(uint32_t from) const {
+    for (size_t i = 1; i < this->count; i++) {
+        const Keyframe& last = this->keyframes[i - 1];
+        const Keyframe& next = this->keyframes[i];
+        uint32_t start = (uint32_t)last.minute * 60;
+        uint32_t end = (uint32_t)next.minute * 60;
+        if (end <= from) {
+            continue;
+        }
+
+        uint32_t second = from > start ? from : start;
+        int32_t span = next.activity - last.activity;
+        if (span <= 0) {
+            // Level or falling, so if there's any activity in this
+            // stretch, there's some at the start of it.
+            if (last.activity + span * (int32_t)(second - start) / (int32_t)(end - start) > 0) {
+                return second;
+            }
+        } else if (last.activity > 0) {
+            return second;
+        } else {
+            // Rising from nothing: activity_at() rounds down, so it's
+            // above 0 once span * (s - start) reaches end - start.
+            uint32_t first = start + (end - start + span - 1) / span;
+            if (first < end) {
+                return second > first ? second : first;
+            }
+        }
+    }
+
+    const Keyframe& final = this->keyframes[this->count - 1];
+    uint32_t start = (uint32_t)final.minute * 60;
+    if (final.activity > 0 && start < this->day_minutes * 60) {
+        return from > start ? from : start;
+    }
+    return UINT32_MAX;
+}
+
+}
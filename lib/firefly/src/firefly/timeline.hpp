@@ -0,0 +1,84 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace firefly {
+
+/*!
+    @brief  One point on an activity curve: how many of the fireflies
+            are out, from 0 (none) to 255 (all of them), some number of
+            minutes after dusk.
+*/
+struct Keyframe {
+    uint16_t minute;
+    uint8_t activity;
+};
+
+
+/*!
+    @brief  How active the fireflies are over the course of an evening,
+            as a curve through a handful of keyframes, repeating every
+            day. Activity is linear between keyframes, and holds at the
+            last keyframe's value until the day starts over.
+*/
+class Timeline {
+  private:
+    const Keyframe* keyframes;
+    size_t count;
+    uint32_t day_minutes;
+
+  public:
+    /*!
+      @param keyframes  The curve, sorted by minute, starting at minute 0.
+      @param count  Number of keyframes.
+      @param day_minutes  How often the curve repeats. A day, normally.
+    */
+    constexpr Timeline(const Keyframe* keyframes, size_t count, uint32_t day_minutes = 24 * 60)
+        : keyframes(keyframes), count(count), day_minutes(day_minutes) {}
+
+    template <size_t Count>
+    constexpr Timeline(const Keyframe (&keyframes)[Count], uint32_t day_minutes = 24 * 60)
+        : Timeline(keyframes, Count, day_minutes) {}
+
+    /*!
+      @brief  How active the fireflies are at some point in the evening.
+      @param  since_dusk  Microseconds since dusk.
+      @return 0 for none at all, up to 255 for all of them.
+    */
+    uint8_t activity_at(uint64_t since_dusk) const;
+
+    /*!
+      @brief  How long until any fireflies are out, for sleeping through
+              the quiet hours.
+      @param  since_dusk  Microseconds since dusk.
+      @return Microseconds until activity_at() is first above 0, which
+              is 0 if it already is, and UINT64_MAX if it never will be.
+    */
+    uint64_t until_active(uint64_t since_dusk) const;
+
+  private:
+    /*!
+      @brief  The first second of the day, from `from` on, with any
+              activity at all, or UINT32_MAX if there's none left today.
+    */
+    uint32_t first_active(uint32_t from) const;
+};
+
+
+namespace timelines {
+
+// P. Pyralis comes out around sunset, is at its busiest within the
+// first half hour, and has mostly given up two hours in.
+inline constexpr Keyframe p_pyralis_evening[] = {
+    {0, 64},
+    {15, 200},
+    {30, 255},
+    {60, 160},
+    {90, 60},
+    {120, 0},
+};
+
+}
+
+}
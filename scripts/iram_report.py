@@ -0,0 +1,82 @@
+# After each ESP8266 build, say how much IRAM is in use, how much is left,
+# and which of the engine's functions are taking up room there (those
+# marked FIREFLY_HOT, with -DFIREFLY_HOT_IRAM=1, and FIREFLY_HOT_LOOP as
+# well with =2).
+#
+# Hooked in from platformio.ini with extra_scripts = post:scripts/iram_report.py.
+# It also runs on its own, to compare builds side by side:
+#
+#     python3 scripts/iram_report.py \
+#         .pio/build/nodemcuv2_bench/firmware.elf \
+#         .pio/build/nodemcuv2_bench_iram/firmware.elf
+#
+# with the xtensa binutils on the PATH (PlatformIO keeps them in
+# ~/.platformio/packages/toolchain-xtensa/bin), or their prefix in
+# FIREFLY_TOOLS.
+
+import os
+import subprocess
+import sys
+
+# Where IRAM code lives on the ESP8266, and how much of it there is with
+# the core's default MMU setup.
+IRAM_START = 0x40100000
+IRAM_SIZE = 32 * 1024
+
+
+def in_iram(address):
+    return IRAM_START <= address < IRAM_START + IRAM_SIZE
+
+
+def measure(elf, tool):
+    used = 0
+    output = subprocess.check_output([tool("size"), "-A", elf], text=True)
+    for line in output.splitlines():
+        fields = line.split()
+        if len(fields) == 3 and fields[1].isdigit() and fields[2].isdigit():
+            if in_iram(int(fields[2])):
+                used += int(fields[1])
+
+    ours = []
+    output = subprocess.check_output([tool("nm"), "-C", "-S", "--size-sort", elf], text=True)
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4 and "firefly::" in fields[3] and in_iram(int(fields[0], 16)):
+            ours.append((int(fields[1], 16), fields[3]))
+    return used, ours
+
+
+def show(elf, tool):
+    used, ours = measure(elf, tool)
+    print("IRAM: %d of %d bytes used, %d left" % (used, IRAM_SIZE, IRAM_SIZE - used))
+    if ours:
+        print("  of which firefly, %d bytes:" % sum(size for size, _ in ours))
+        for size, name in sorted(ours, reverse=True):
+            print("  %6d  %s" % (size, name))
+    return used
+
+
+# PlatformIO runs this as an SConscript, which is what gives it Import().
+if "Import" not in globals():
+    prefix = os.environ.get("FIREFLY_TOOLS", "xtensa-lx106-elf-")
+    baseline = None
+    for elf in sys.argv[1:]:
+        print(elf)
+        used = show(elf, lambda name: prefix + name)
+        if baseline is not None:
+            print("  %+d bytes of IRAM against %s" % (used - baseline[1], baseline[0]))
+        else:
+            baseline = (elf, used)
+else:
+    Import("env")
+
+    def tool(name):
+        # The size tool is the only binutil PlatformIO names for us, and
+        # the others sit right next to it.
+        size = env.subst("$SIZETOOL")
+        return size[: -len("size")] + name
+
+    def report(source, target, env):
+        show(str(target[0]), tool)
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)
@@ -0,0 +1,118 @@
+// The compositor's afterglow pass over the whole frame, from 10 to 4096
+// LEDs, against the same fade done a channel at a time. Both are checked
+// to come out the same before they're timed.
+
+#include <cmath>
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+class NullSink : public firefly::OutputSink {
+  public:
+    void set_pixel(uint16_t, uint32_t rgb) override { bench::keep(rgb); }
+    void show() override {}
+};
+
+
+const uint32_t PIXELS = 4000000;
+
+
+/*!
+    @brief The afterglow a channel at a time, the obvious way.
+*/
+void fade_channels(std::vector<uint32_t>& frame, const std::vector<uint32_t>& target, uint32_t factor) {
+    for (size_t i = 0; i < frame.size(); i++) {
+        uint32_t out = 0;
+        for (int shift = 0; shift < 24; shift += 8) {
+            uint32_t old = ((frame[i] >> shift) & 0xFF) * factor >> 8;
+            uint32_t want = (target[i] >> shift) & 0xFF;
+            out |= (want > old ? want : old) << shift;
+        }
+        frame[i] = out;
+    }
+}
+
+
+template <size_t N>
+void afterglow() {
+    const firefly::Species& species = firefly::species::p_pyralis;
+    const uint32_t FRAMES = PIXELS / N;
+    // Frames a millisecond apart with a 50 ms time constant, worked out
+    // the way the compositor does.
+    const uint32_t FRAME_US = 1024;
+    const uint32_t FACTOR = std::exp(-(FRAME_US / 256 * 256.0f) / 50000.0f) * 256;
+
+    NullSink sink;
+    auto compositor = std::make_unique<firefly::Compositor<N>>(sink);
+    compositor->clear();
+    compositor->set_afterglow(50);
+
+    // Everything lit to start with, then most of it going dark, so the
+    // pass has plenty of fading to do.
+    std::vector<uint32_t> frame(N), target(N);
+    firefly::XorShiftRng rng(1);
+    std::vector<uint8_t> levels(N);
+    for (size_t i = 0; i < N; i++) {
+        levels[i] = rng.random(0, 256);
+        compositor->put(i, species, levels[i]);
+        frame[i] = species.color(levels[i]);
+        target[i] = i % 8 ? 0 : frame[i];
+    }
+    uint64_t now = FRAME_US;
+    compositor->show(now);
+    for (size_t i = 0; i < N; i++) {
+        compositor->put(i, species, i % 8 ? 0 : levels[i]);
+    }
+
+    // The same frames both ways should come out identical.
+    for (int f = 0; f < 32; f++) {
+        now += FRAME_US;
+        compositor->show(now);
+        fade_channels(frame, target, FACTOR);
+    }
+    for (size_t i = 0; i < N; i++) {
+        if (frame[i] != compositor->get_frame()[i]) {
+            std::printf("afterglow<%zu>: LED %zu is %06x, should be %06x\n",
+                        N, i, compositor->get_frame()[i], frame[i]);
+            std::exit(1);
+        }
+    }
+
+    double swar = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            now += FRAME_US;
+            compositor->show(now);
+        }
+    }, FRAMES);
+    double channels = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            fade_channels(frame, target, FACTOR);
+        }
+        bench::keep(frame);
+    }, FRAMES);
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "Compositor<%zu>::show", N);
+    bench::report("afterglow", label, swar / 1000, "us/frame");
+    std::snprintf(label, sizeof(label), "  per LED");
+    bench::report("afterglow", label, swar / N, "ns/LED");
+    std::snprintf(label, sizeof(label), "  a channel at a time");
+    bench::report("afterglow", label, channels / N, "ns/LED");
+}
+
+}
+
+
+BENCHMARK(afterglow) {
+    afterglow<10>();
+    afterglow<64>();
+    afterglow<256>();
+    afterglow<1024>();
+    afterglow<4096>();
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+// A very small benchmark harness for the host. Each file in src/bench
+// registers its cases with BENCHMARK(name), and main.cpp runs the ones
+// matching the filter given on the command line.
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace bench {
+
+using Function = void (*)();
+
+struct Case {
+    const char* name;
+    Function function;
+};
+
+std::vector<Case>& registry();
+
+struct Register {
+    Register(const char* name, Function function) { registry().push_back({name, function}); }
+};
+
+/*!
+    @brief Stop the compiler from optimizing a value away.
+*/
+template <typename T>
+inline void keep(const T& value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+/*!
+    @brief Time a piece of work.
+    @param body  Called with no arguments, does `ops` operations.
+    @param ops  How many operations one call of body does.
+    @return The best nanoseconds per operation out of a few runs.
+*/
+template <typename F>
+double measure(F&& body, uint64_t ops) {
+    using clock = std::chrono::steady_clock;
+    double best = 1e300;
+
+    body();
+    for (int run = 0; run < 5; run++) {
+        auto start = clock::now();
+        body();
+        auto end = clock::now();
+        double ns = std::chrono::duration<double, std::nano>(end - start).count() / ops;
+        if (ns < best) {
+            best = ns;
+        }
+    }
+    return best;
+}
+
+/*!
+    @brief Print one result line.
+*/
+inline void report(const char* group, const char* label, double value, const char* unit) {
+    std::printf("%-28s %-36s %12.2f %s\n", group, label, value, unit);
+}
+
+}
+
+#define BENCHMARK(name)                                                    \
+    static void bench_##name();                                            \
+    static bench::Register register_##name(#name, bench_##name);           \
+    static void bench_##name()
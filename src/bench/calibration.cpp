@@ -0,0 +1,133 @@
+// What correcting each LED on its way to the wire costs: a compositor
+// packing into a strip's buffer with a calibration table, against the
+// same compositor packing everything in the strip's one order.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+const size_t LEDS = 300;
+const uint32_t FRAMES = 2000;
+// Runs of each, taken in turn so that whatever else the machine is up
+// to lands on both about the same.
+const int ROUNDS = 15;
+
+
+/*!
+    @brief Packs straight into its own bytes, like NeoPixelSink does,
+           with or without a calibration.
+*/
+class WireSink : public firefly::OutputSink {
+  private:
+    firefly::Wire wire;
+
+  public:
+    std::vector<uint8_t> bytes;
+
+    WireSink(uint8_t order, const firefly::LedCalibration* calibration)
+        : wire{nullptr, order, calibration}, bytes(3 * LEDS) {
+        this->wire.bytes = this->bytes.data();
+    }
+    void set_pixel(uint16_t index, uint32_t rgb) override { this->wire.pack(index, rgb); }
+    void show() override { bench::keep(this->bytes); }
+    const firefly::Wire* get_wire() override { return &this->wire; }
+};
+
+
+/*!
+  @brief Every LED, every frame, at a brightness that keeps changing.
+*/
+void frames(firefly::Compositor<LEDS>& compositor) {
+    const firefly::Species& species = firefly::species::p_pyralis;
+    for (uint32_t f = 0; f < FRAMES; f++) {
+        for (size_t i = 0; i < LEDS; i++) {
+            compositor.put(i, species, (f + i) & 0xFF);
+        }
+        compositor.show();
+    }
+}
+
+
+/*!
+  @return Nanoseconds per LED for one run of frames().
+*/
+double once(firefly::Compositor<LEDS>& compositor) {
+    using clock = std::chrono::steady_clock;
+    auto start = clock::now();
+    frames(compositor);
+    auto end = clock::now();
+    return std::chrono::duration<double, std::nano>(end - start).count() / ((uint64_t)FRAMES * LEDS);
+}
+
+
+double median(std::vector<double> runs) {
+    std::sort(runs.begin(), runs.end());
+    return runs[runs.size() / 2];
+}
+
+}
+
+
+BENCHMARK(calibration) {
+    WireSink plain(firefly::order::bgr, nullptr);
+    auto same = firefly::uncalibrated<LEDS>(firefly::order::bgr);
+    WireSink as_is(firefly::order::bgr, same.data());
+
+    // A strip that really needs it: every LED a bit different, and the
+    // odd one wired the other way round.
+    auto varied = firefly::uncalibrated<LEDS>(firefly::order::bgr);
+    firefly::XorShiftRng rng(1);
+    for (size_t i = 0; i < LEDS; i++) {
+        varied[i].red = rng.random(200, 256);
+        varied[i].green = rng.random(200, 256);
+        varied[i].blue = rng.random(200, 256);
+        if (i % 50 == 7) {
+            varied[i].order = firefly::order::rgb;
+        }
+    }
+    WireSink calibrated(firefly::order::bgr, varied.data());
+
+    auto uncorrected = std::make_unique<firefly::Compositor<LEDS>>(plain);
+    auto unchanged = std::make_unique<firefly::Compositor<LEDS>>(as_is);
+    auto corrected = std::make_unique<firefly::Compositor<LEDS>>(calibrated);
+    for (auto* compositor : {uncorrected.get(), unchanged.get(), corrected.get()}) {
+        compositor->clear();
+    }
+
+    // Left as they are, calibrated LEDs should go out exactly as the
+    // strip's order would send them.
+    frames(*uncorrected);
+    frames(*unchanged);
+    frames(*corrected);
+    if (std::memcmp(plain.bytes.data(), as_is.bytes.data(), 3 * LEDS) != 0) {
+        std::printf("calibration: uncalibrated LEDs don't match the strip's order\n");
+        std::exit(1);
+    }
+
+    std::vector<double> without, with;
+    for (int round = 0; round < ROUNDS; round++) {
+        // Swap which goes first, too.
+        if (round % 2) {
+            without.push_back(once(*uncorrected));
+            with.push_back(once(*corrected));
+        } else {
+            with.push_back(once(*corrected));
+            without.push_back(once(*uncorrected));
+        }
+    }
+    double before = median(without);
+    double after = median(with);
+
+    bench::report("calibration", "Compositor, no calibration", before, "ns/LED");
+    bench::report("calibration", "Compositor, calibrated", after, "ns/LED");
+    bench::report("calibration", "overhead", (after / before - 1) * 100, "%");
+}
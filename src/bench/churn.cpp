@@ -0,0 +1,109 @@
+// Taking fireflies out of a jar and putting them back, as a predator
+// does: the jar's O(1) hold()/release() against keeping the active ones
+// in a std::vector and erasing and appending, and what a frame costs
+// with and without a firefly coming and going every frame.
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+class NullSink : public firefly::OutputSink {
+  public:
+    void set_pixel(uint16_t, uint32_t rgb) override { bench::keep(rgb); }
+    void show() override {}
+};
+
+
+const uint32_t OPS = 100000;
+const size_t N = 1000;
+
+
+void jar_churn() {
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(1);
+    firefly::XorShiftRng picks(2);
+    auto jar = std::make_unique<firefly::Jar<N>>(sink, clock, rng);
+    jar->begin();
+
+    double ns = bench::measure([&] {
+        for (uint32_t i = 0; i < OPS; i++) {
+            uint16_t index = picks.random(0, N);
+            jar->hold(index);
+            jar->release(index);
+        }
+    }, 2 * OPS);
+    bench::report("churn", "Jar<1000> hold/release", ns, "ns/op");
+}
+
+
+void vector_churn() {
+    firefly::XorShiftRng picks(2);
+    std::vector<uint16_t> active;
+    for (size_t i = 0; i < N; i++) {
+        active.push_back(i);
+    }
+
+    double ns = bench::measure([&] {
+        for (uint32_t i = 0; i < OPS; i++) {
+            uint16_t index = picks.random(0, N);
+            active.erase(std::find(active.begin(), active.end(), index));
+            active.push_back(index);
+        }
+    }, 2 * OPS);
+    bench::keep(active);
+    bench::report("churn", "vector<1000> erase/push_back", ns, "ns/op");
+}
+
+
+void frames(bool churn) {
+    const uint32_t FRAMES = 20000;
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(1);
+    firefly::XorShiftRng picks(2);
+    auto jar = std::make_unique<firefly::Jar<N>>(sink, clock, rng);
+    jar->begin();
+
+    // Hold a tenth of the jar, then swap one held firefly for one out
+    // every frame. Released fireflies start off dark, so churn can come
+    // out cheaper than none: what matters is that it isn't dearer.
+    std::vector<uint16_t> held;
+    for (size_t i = 0; i < N / 10; i++) {
+        held.push_back(i * 10);
+        jar->hold(i * 10);
+    }
+
+    double ns = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            clock.advance(1000);
+            if (churn) {
+                uint16_t& slot = held[f % held.size()];
+                jar->release(slot);
+                do {
+                    slot = picks.random(0, N);
+                } while (jar->is_held(slot));
+                jar->hold(slot);
+            }
+            jar->update();
+        }
+    }, FRAMES);
+    bench::report("churn", churn ? "Jar<1000> frame, 1 in 1 out" : "Jar<1000> frame, no churn",
+                  ns / 1000, "us/frame");
+}
+
+}
+
+
+BENCHMARK(churn) {
+    jar_churn();
+    vector_churn();
+    frames(false);
+    frames(true);
+}
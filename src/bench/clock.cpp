@@ -0,0 +1,43 @@
+// What reading the time costs: the raw 32 bit counter, and the same
+// counter stretched to 64 bits by Clock::now().
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+const uint32_t READS = 10000000;
+
+
+// Moves on by a microsecond each read, so now() sees a wrap
+// every 2^32 reads, just like on the jar.
+class CountingClock : public firefly::Clock {
+  private:
+    uint32_t raw = 0;
+
+  public:
+    uint32_t micros() override { return this->raw++; }
+};
+
+}
+
+
+BENCHMARK(clock) {
+    CountingClock clock;
+    firefly::Clock& base = clock;
+
+    double ns = bench::measure([&] {
+        for (uint32_t i = 0; i < READS; i++) {
+            bench::keep(base.micros());
+        }
+    }, READS);
+    bench::report("clock", "Clock::micros() (32 bit)", ns, "ns/read");
+
+    ns = bench::measure([&] {
+        for (uint32_t i = 0; i < READS; i++) {
+            bench::keep(base.now());
+        }
+    }, READS);
+    bench::report("clock", "Clock::now() (64 bit)", ns, "ns/read");
+}
@@ -0,0 +1,119 @@
+// The same flash done four ways: the Firefly state machine the Jar uses,
+// the stepped switch based state machine, and (when built as C++20) a
+// stackless coroutine. The AceRoutine version needs the ESP8266, see
+// src/bench_device for that one.
+
+#include <memory>
+#include <vector>
+
+#include <firefly.hpp>
+#include <firefly/flash/coroutine_flash.hpp>
+#include <firefly/flash/switch_flash.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+// Give the Firefly the same resume(now) shape as the stepped ones.
+class AnalyticFlash : public firefly::Firefly {
+  private:
+    firefly::Rng* rng;
+    firefly::Timing timing;
+
+  public:
+    AnalyticFlash(const firefly::Species& species, firefly::Rng& rng)
+        : firefly::Firefly(0, species), rng(&rng), timing(firefly::Timing::of(species)) {
+        this->begin(0, rng, this->timing);
+    }
+
+    void resume(uint64_t now) { this->update(now, *this->rng, this->timing); }
+};
+
+
+const uint32_t CALLS = 200000;
+
+
+/*!
+  @param bytes  What each firefly costs in memory: only what a jar of
+         them would keep per firefly, not what the adapters here carry
+         around for convenience.
+*/
+template <typename Flash>
+void suite(const char* name, size_t bytes) {
+    firefly::XorShiftRng rng(1);
+    char label[64];
+
+    std::snprintf(label, sizeof(label), "%s memory", name);
+    bench::report("flash_impl", label, bytes, "bytes/firefly");
+
+    // Resume when the next step is due: every call moves time on far
+    // enough that even the longest dark delay is over.
+    {
+        Flash flash(firefly::species::p_pyralis, rng);
+        uint64_t now = 0;
+        double ns = bench::measure([&] {
+            for (uint32_t i = 0; i < CALLS; i++) {
+                now += 10000000;
+                flash.resume(now);
+                bench::keep(flash.get_brightness());
+            }
+        }, CALLS);
+        std::snprintf(label, sizeof(label), "%s resume (due)", name);
+        bench::report("flash_impl", label, ns, "ns/resume");
+    }
+
+    // Resume when nothing is due yet, which is most calls on the jar.
+    {
+        Flash flash(firefly::species::p_pyralis, rng);
+        flash.resume(0);
+        double ns = bench::measure([&] {
+            for (uint32_t i = 0; i < CALLS; i++) {
+                flash.resume(1);
+                bench::keep(flash.get_brightness());
+            }
+        }, CALLS);
+        std::snprintf(label, sizeof(label), "%s resume (not due)", name);
+        bench::report("flash_impl", label, ns, "ns/resume");
+    }
+
+    // A whole jar's worth, stepped in 1 ms frames like the real loop.
+    for (size_t n : {10, 100, 1000}) {
+        std::vector<std::unique_ptr<Flash>> jar;
+        for (size_t i = 0; i < n; i++) {
+            jar.emplace_back(new Flash(firefly::species::p_pyralis, rng));
+        }
+        const uint32_t FRAMES = 20000;
+        uint64_t now = 0;
+        double ns = bench::measure([&] {
+            for (uint32_t f = 0; f < FRAMES; f++) {
+                now += 1000;
+                for (auto& flash : jar) {
+                    flash->resume(now);
+                }
+            }
+        }, (uint64_t)FRAMES * n);
+        std::snprintf(label, sizeof(label), "%s loop x%zu", name, n);
+        bench::report("flash_impl", label, ns, "ns/firefly");
+    }
+}
+
+}
+
+
+BENCHMARK(flash_impl) {
+    // The adapter's Rng pointer and Timing are one per jar, not one per
+    // firefly: a Jar keeps just the Firefly for each, and those once.
+    suite<AnalyticFlash>("Firefly", sizeof(firefly::Firefly));
+    bench::report("flash_impl", "Firefly shared memory", sizeof(firefly::Timing) + sizeof(firefly::Rng*),
+                  "bytes/jar");
+    // The stepped ones keep their species and Rng pointers in every
+    // firefly, so those do count.
+    suite<firefly::flash::SwitchFlash>("SwitchFlash", sizeof(firefly::flash::SwitchFlash));
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+    // Make one first, so we know how big its frame is.
+    firefly::XorShiftRng rng(1);
+    firefly::flash::CoroutineFlash probe(firefly::species::p_pyralis, rng);
+    suite<firefly::flash::CoroutineFlash>("CoroutineFlash", sizeof(firefly::flash::CoroutineFlash)
+                                          + firefly::flash::CoroutineFlash::last_frame_size);
+#endif
+}
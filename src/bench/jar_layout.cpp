@@ -0,0 +1,125 @@
+// Jar<N> with its fireflies in a std::array, against the old layout of
+// a std::vector of individually allocated fireflies. The layouts are
+// compared with the same bare loop over each, so that only where the
+// fireflies live differs; the whole Jar<N>::update(), which does a good
+// deal more per frame (the active list, batched rolls, the compositor),
+// is timed alongside for reference.
+//
+// The two frame() functions are kept out of line so their code size can
+// be read off the binary, e.g. `nm -C --size-sort -S` and look for
+// frame<.
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+class NullSink : public firefly::OutputSink {
+  public:
+    void set_pixel(uint16_t, uint32_t rgb) override { bench::keep(rgb); }
+    void show() override {}
+};
+
+
+// How many 1 ms frames each measurement runs for.
+const uint32_t FRAMES = 20000;
+
+const firefly::Species& species = firefly::species::p_pyralis;
+
+
+firefly::Firefly& at(firefly::Firefly& firefly) { return firefly; }
+firefly::Firefly& at(firefly::Firefly* firefly) { return *firefly; }
+
+
+/*!
+  @brief One frame of what main.cpp used to do, over either layout.
+*/
+template <typename Fireflies>
+__attribute__((noinline)) void frame(Fireflies& fireflies, uint32_t now, firefly::Rng& rng,
+                                     const firefly::Timing& timing, firefly::OutputSink& sink) {
+    bool dirty = false;
+    for (auto& f : fireflies) {
+        firefly::Firefly& firefly = at(f);
+        if (firefly.update(now, rng, timing) && firefly.is_visible()) {
+            sink.set_pixel(firefly.number, firefly.get_species().color(firefly.get_brightness()));
+            dirty = true;
+        }
+    }
+    if (dirty) {
+        sink.show();
+    }
+}
+
+
+template <typename Fireflies>
+double frames(Fireflies& fireflies, size_t count) {
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(1);
+    firefly::Timing timing = firefly::Timing::of(species);
+    for (auto& f : fireflies) {
+        at(f).begin(0, rng, timing);
+    }
+    return bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            clock.advance(1000);
+            frame(fireflies, clock.micros(), rng, timing, sink);
+        }
+    }, (uint64_t)FRAMES * count);
+}
+
+
+template <size_t N>
+void layouts() {
+    auto array = std::make_unique<std::array<firefly::Firefly, N>>();
+    for (size_t i = 0; i < N; i++) {
+        (*array)[i] = firefly::Firefly(i, species);
+    }
+
+    // Grown one at a time, as main.cpp used to.
+    std::vector<firefly::Firefly*> pointers;
+    for (size_t i = 0; i < N; i++) {
+        pointers.push_back(new firefly::Firefly(i, species));
+    }
+
+    double in_array = frames(*array, N);
+    double through_pointers = frames(pointers, N);
+
+    for (firefly::Firefly* firefly : pointers) {
+        delete firefly;
+    }
+
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(1);
+    auto jar = std::make_unique<firefly::Jar<N>>(sink, clock, rng);
+    jar->begin();
+    double whole = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            clock.advance(1000);
+            jar->update();
+        }
+    }, (uint64_t)FRAMES * N);
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "std::array<Firefly> x%zu", N);
+    bench::report("jar_layout", label, in_array, "ns/firefly");
+    std::snprintf(label, sizeof(label), "vector<Firefly*> x%zu", N);
+    bench::report("jar_layout", label, through_pointers, "ns/firefly");
+    std::snprintf(label, sizeof(label), "Jar<%zu>::update()", N);
+    bench::report("jar_layout", label, whole, "ns/firefly");
+}
+
+}
+
+
+BENCHMARK(jar_layout) {
+    layouts<10>();
+    layouts<100>();
+    layouts<1000>();
+}
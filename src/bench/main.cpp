@@ -0,0 +1,35 @@
+/*
+Host benchmarks for the firefly engine.
+
+    bench [filter]
+
+Runs every benchmark whose name contains the filter, or all of them.
+These measure the engine on the computer they run on, which is a lot
+faster than an ESP8266, so compare the numbers with each other rather
+than with the jar.
+*/
+
+#include <cstring>
+
+#include "bench.hpp"
+
+namespace bench {
+
+std::vector<Case>& registry() {
+    static std::vector<Case> cases;
+    return cases;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    const char* filter = argc > 1 ? argv[1] : "";
+
+    for (const bench::Case& c : bench::registry()) {
+        if (std::strstr(c.name, filter)) {
+            c.function();
+        }
+    }
+    return 0;
+}
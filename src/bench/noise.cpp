@@ -0,0 +1,61 @@
+// The flicker's noise on its own, and what turning the flicker on does
+// to a whole frame of a jar.
+
+#include <memory>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+class NullSink : public firefly::OutputSink {
+  public:
+    void set_pixel(uint16_t, uint32_t rgb) override { bench::keep(rgb); }
+    void show() override {}
+};
+
+
+const uint32_t SAMPLES = 10000000;
+
+
+template <size_t N>
+void frames(uint8_t depth) {
+    const uint32_t FRAMES = 20000;
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(1);
+    auto jar = std::make_unique<firefly::Jar<N>>(sink, clock, rng);
+    jar->set_flicker(depth);
+    jar->begin();
+
+    double ns = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            clock.advance(1000);
+            jar->update();
+        }
+    }, FRAMES);
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "Jar<%zu> frame, flicker %s", N, depth ? "on" : "off");
+    bench::report("noise", label, ns / 1000, "us/frame");
+}
+
+}
+
+
+BENCHMARK(noise) {
+    // Step by a little under a cell, like a frame does, so every sample
+    // interpolates.
+    double ns = bench::measure([&] {
+        uint32_t x = 0;
+        for (uint32_t i = 0; i < SAMPLES; i++) {
+            bench::keep(firefly::noise::sample(x));
+            x += 0x9E;
+        }
+    }, SAMPLES);
+    bench::report("noise", "noise::sample", ns, "ns/sample");
+
+    frames<100>(0);
+    frames<100>(32);
+}
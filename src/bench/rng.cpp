@@ -0,0 +1,110 @@
+// What a draw costs from each generator, and what a firefly's roll costs
+// keyed to a CounterRng rather than drawing from a stateful one. Before
+// timing, a jar's worth of fireflies rolls twice over in different orders
+// to check the keyed rolls really don't depend on it.
+
+#include <cstdlib>
+#include <vector>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+const uint32_t DRAWS = 10000000;
+const uint32_t ROLLS = 2000000;
+const size_t FIREFLIES = 10;
+
+
+/*!
+  @brief Roll every firefly a few times, in one order or the other, with
+         someone else drawing in between, and note how bright each flash
+         gets.
+*/
+std::vector<uint8_t> peaks(firefly::Rng& rng, bool backwards) {
+    const firefly::Timing timing = firefly::Timing::of(firefly::species::p_pyralis);
+    std::vector<firefly::Firefly> fireflies;
+    for (size_t i = 0; i < FIREFLIES; i++) {
+        fireflies.emplace_back(i, firefly::species::p_pyralis);
+    }
+
+    std::vector<uint8_t> peaks(FIREFLIES * 8);
+    for (size_t round = 0; round < 8; round++) {
+        for (size_t n = 0; n < FIREFLIES; n++) {
+            size_t i = backwards ? FIREFLIES - 1 - n : n;
+            fireflies[i].roll(rng, timing);
+            peaks[i * 8 + round] = fireflies[i].get_peak();
+            if (backwards) {
+                rng.next();
+            }
+        }
+    }
+    return peaks;
+}
+
+
+template <typename R>
+double rolls(R& rng) {
+    const firefly::Timing timing = firefly::Timing::of(firefly::species::p_pyralis);
+    firefly::Firefly firefly(3, firefly::species::p_pyralis);
+    return bench::measure([&] {
+        for (uint32_t i = 0; i < ROLLS; i++) {
+            firefly.roll(rng, timing);
+        }
+        bench::keep(firefly);
+    }, ROLLS);
+}
+
+}
+
+
+BENCHMARK(rng) {
+    {
+        firefly::CounterRng forwards(7), backwards(7);
+        if (peaks(forwards, false) != peaks(backwards, true)) {
+            std::printf("rng: CounterRng rolls depend on the order fireflies roll in\n");
+            std::exit(1);
+        }
+        firefly::XorShiftRng stateful_forwards(7), stateful_backwards(7);
+        bool same = peaks(stateful_forwards, false) == peaks(stateful_backwards, true);
+        std::printf("rng: rolls in a different order: CounterRng the same, XorShiftRng %s\n",
+                    same ? "the same" : "different");
+    }
+
+    firefly::XorShiftRng xorshift(1);
+    firefly::XorShiftRng source(1);
+    firefly::PooledRng pooled(source);
+    firefly::CounterRng counter(1);
+
+    double ns = bench::measure([&] {
+        for (uint32_t i = 0; i < DRAWS; i++) {
+            bench::keep(xorshift.next());
+        }
+    }, DRAWS);
+    bench::report("rng", "XorShiftRng::next", ns, "ns/draw");
+
+    // Topped up every so often, like the background tier does.
+    ns = bench::measure([&] {
+        for (uint32_t i = 0; i < DRAWS; i++) {
+            if (i % 16 == 0) {
+                pooled.run(0);
+            }
+            bench::keep(pooled.next());
+        }
+    }, DRAWS);
+    bench::report("rng", "PooledRng::next", ns, "ns/draw");
+
+    ns = bench::measure([&] {
+        for (uint32_t i = 0; i < DRAWS; i++) {
+            bench::keep(counter.draw(i & 0xFF, i >> 8, 2));
+        }
+    }, DRAWS);
+    bench::report("rng", "CounterRng::draw", ns, "ns/draw");
+
+    // Through the Rng interface, the way a firefly draws.
+    firefly::Rng& stateful = xorshift;
+    firefly::Rng& keyed = counter;
+    bench::report("rng", "Firefly::roll, XorShiftRng", rolls(stateful), "ns/roll");
+    bench::report("rng", "Firefly::roll, CounterRng", rolls(keyed), "ns/roll");
+}
@@ -0,0 +1,207 @@
+// Rolling new timings for fireflies whose flashes have ended: one roll()
+// at a time, as each flash ends, against gathering them up and rolling
+// for all of them in one go (Rolls), first on their own and then over
+// frames of a few thousand fireflies with dozens of flashes ending in
+// each. Before timing, both ways have to give every firefly the same
+// timings, from a stateful Rng and a CounterRng alike.
+
+#include <cstdlib>
+#include <memory>
+#include <vector>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+class NullSink : public firefly::OutputSink {
+  public:
+    void set_pixel(uint16_t, uint32_t rgb) override { bench::keep(rgb); }
+    void show() override {}
+};
+
+
+const firefly::Timing timing = firefly::Timing::of(firefly::species::p_pyralis);
+const uint32_t ROLLS = 1000000;
+
+
+std::vector<firefly::Firefly> fireflies(size_t count) {
+    std::vector<firefly::Firefly> fireflies;
+    for (size_t i = 0; i < count; i++) {
+        fireflies.emplace_back(i, firefly::species::p_pyralis);
+    }
+    return fireflies;
+}
+
+
+bool same(const firefly::Firefly& a, const firefly::Firefly& b) {
+    firefly::Firefly::Checkpoint x = a.save(0), y = b.save(0);
+    return x.rolls == y.rolls && x.dark_delay == y.dark_delay && x.peak == y.peak
+        && x.rising_delay == y.rising_delay && x.falling_delay == y.falling_delay;
+}
+
+
+/*!
+  @brief Roll a hundred fireflies a few times over, one at a time with one
+         Rng and in batches with another seeded the same, and check they
+         agree, and that the Rngs end up in the same place.
+*/
+template <typename R>
+void check(const char* name) {
+    const size_t COUNT = 100;
+    R one(7), batch(7);
+    std::vector<firefly::Firefly> a = fireflies(COUNT), b = fireflies(COUNT);
+    static firefly::Rolls<32> rolls;
+
+    for (int round = 0; round < 5; round++) {
+        for (size_t i = 0; i < COUNT; i++) {
+            a[i].roll(one, timing);
+            rolls.add(b[i], timing);
+            if (rolls.full() || i == COUNT - 1) {
+                rolls.roll(batch);
+                rolls.clear();
+            }
+        }
+    }
+    for (size_t i = 0; i < COUNT; i++) {
+        if (!same(a[i], b[i])) {
+            std::printf("rolls: %s firefly %zu rolled differently in a batch\n", name, i);
+            std::exit(1);
+        }
+    }
+    if (one.next() != batch.next()) {
+        std::printf("rolls: %s drew a different amount in a batch\n", name);
+        std::exit(1);
+    }
+}
+
+
+void one_at_a_time(firefly::Rng& rng, const char* name) {
+    std::vector<firefly::Firefly> group = fireflies(1024);
+    double ns = bench::measure([&] {
+        for (uint32_t i = 0; i < ROLLS; i++) {
+            group[i % 1024].roll(rng, timing);
+        }
+        bench::keep(group);
+    }, ROLLS);
+    char label[64];
+    std::snprintf(label, sizeof(label), "one at a time, %s", name);
+    bench::report("rolls", label, ns, "ns/roll");
+}
+
+
+template <size_t B>
+void batched(firefly::Rng& rng, const char* name) {
+    std::vector<firefly::Firefly> group = fireflies(B);
+    auto rolls = std::make_unique<firefly::Rolls<B>>();
+    double ns = bench::measure([&] {
+        for (uint32_t i = 0; i < ROLLS / B; i++) {
+            for (size_t k = 0; k < B; k++) {
+                rolls->add(group[k], timing);
+            }
+            rolls->roll(rng);
+            rolls->clear();
+        }
+        bench::keep(group);
+    }, ROLLS / B * B);
+    char label[64];
+    std::snprintf(label, sizeof(label), "batches of %zu, %s", B, name);
+    bench::report("rolls", label, ns, "ns/roll");
+}
+
+
+/*!
+  @brief Step a few thousand fireflies a frame at a time, frames far
+         enough apart that dozens of flashes end in each, rolling either
+         as they go or in batches of B (0 for as they go).
+*/
+template <size_t B>
+void frames(const char* label) {
+    const size_t COUNT = 4096;
+    const uint32_t FRAMES = 2000;
+    const uint32_t TICK = 20000;
+    firefly::CounterRng rng(1);
+    firefly::Rng& keyed = rng;
+    std::vector<firefly::Firefly> group = fireflies(COUNT);
+    for (firefly::Firefly& firefly : group) {
+        firefly.warm(0, keyed, timing);
+    }
+    static firefly::Rolls<(B ? B : 1)> rolls;
+
+    uint64_t now = 0;
+    unsigned long ended = 0;
+    double ns = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            now += TICK;
+            for (firefly::Firefly& firefly : group) {
+                if (!B) {
+                    bench::keep(firefly.update(now, keyed, timing));
+                    continue;
+                }
+                bench::keep(firefly.update(now));
+                if (firefly.is_unrolled()) {
+                    ended++;
+                    rolls.add(firefly, timing);
+                    if (rolls.full()) {
+                        rolls.roll(keyed);
+                        rolls.clear();
+                    }
+                }
+            }
+            rolls.roll(keyed);
+            rolls.clear();
+        }
+    }, FRAMES);
+    bench::report("rolls", label, ns / 1000, "us/frame");
+    if (B) {
+        // Over the warm-up and the five timed runs.
+        bench::report("rolls", "  flashes ending per frame", (double)ended / (6 * FRAMES), "");
+    }
+}
+
+
+void jar_frames() {
+    const size_t N = 4096;
+    const uint32_t FRAMES = 2000;
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::CounterRng rng(1);
+    auto jar = std::make_unique<firefly::Jar<N>>(sink, clock, rng);
+    jar->begin();
+
+    double ns = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            clock.advance(20000);
+            jar->update();
+        }
+    }, FRAMES);
+    bench::report("rolls", "Jar<4096>, 20 ms frames", ns / 1000, "us/frame");
+}
+
+}
+
+
+BENCHMARK(rolls) {
+    check<firefly::XorShiftRng>("XorShiftRng");
+    check<firefly::CounterRng>("CounterRng");
+
+    // Through the Rng interface, the way the jar draws.
+    firefly::XorShiftRng xorshift(1);
+    firefly::CounterRng counter(1);
+    firefly::Rng& stateful = xorshift;
+    firefly::Rng& keyed = counter;
+    one_at_a_time(stateful, "XorShiftRng");
+    batched<8>(stateful, "XorShiftRng");
+    batched<32>(stateful, "XorShiftRng");
+    batched<256>(stateful, "XorShiftRng");
+    one_at_a_time(keyed, "CounterRng");
+    batched<8>(keyed, "CounterRng");
+    batched<32>(keyed, "CounterRng");
+    batched<256>(keyed, "CounterRng");
+
+    frames<0>("4096 fireflies, rolling as they go");
+    frames<32>("4096 fireflies, batches of 32");
+    frames<256>("4096 fireflies, batches of 256");
+    jar_frames();
+}
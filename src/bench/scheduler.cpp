@@ -0,0 +1,103 @@
+// How late frames start when background work shares the loop: once with
+// everything run in turn like the old loop(), once through the Scheduler.
+
+#include <firefly.hpp>
+#include <firefly/host.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+class NullSink : public firefly::OutputSink, public firefly::TextSink {
+  public:
+    void set_pixel(uint16_t, uint32_t rgb) override { bench::keep(rgb); }
+    void show() override {}
+    size_t write(const char*, size_t length) override { return length; }
+};
+
+
+// Stands in for something slow, like formatting a report.
+class BusyTask : public firefly::Task {
+  private:
+    firefly::Clock& clock;
+    uint32_t length;
+
+  public:
+    BusyTask(firefly::Clock& clock, uint32_t length) : clock(clock), length(length) {}
+
+    void run(uint32_t now) override {
+        while (this->clock.micros() - now < this->length) {
+        }
+    }
+};
+
+
+const uint32_t RUN_US = 1000000;
+
+
+void run(bool tiered) {
+    firefly::host::SteadyClock clock;
+    NullSink sink;
+    firefly::XorShiftRng source(1);
+    firefly::PooledRng rng(source);
+    firefly::Jar<100> jar(sink, clock, rng);
+    firefly::Telemetry telemetry(sink);
+    BusyTask busy(clock, 300);
+    firefly::Profiler profiler;
+    firefly::Scheduler scheduler(clock, profiler);
+
+    jar.begin();
+    scheduler.add_realtime(jar, FIREFLY_FRAME_PERIOD_US);
+    scheduler.add_background(rng, 20);
+    scheduler.add_background(telemetry, 20);
+    scheduler.add_background(busy, 350);
+
+    uint32_t start = clock.micros();
+    if (tiered) {
+        while (clock.micros() - start < RUN_US) {
+            telemetry.write("some telemetry\n");
+            scheduler.loop();
+        }
+    } else {
+        // The old way: everything, every time around.
+        uint32_t deadline = start;
+        uint32_t last_round = start;
+        while (clock.micros() - start < RUN_US) {
+            telemetry.write("some telemetry\n");
+            uint32_t now = clock.micros();
+            if ((int32_t)(now - deadline) >= 0) {
+                jar.run(now);
+                profiler.record(firefly::Tier::realtime, now - deadline, clock.micros() - now);
+                deadline += FIREFLY_FRAME_PERIOD_US;
+            }
+            // Every background task waits one whole time around the loop.
+            uint32_t round = clock.micros();
+            for (firefly::Task* task : {(firefly::Task*)&rng, (firefly::Task*)&telemetry, (firefly::Task*)&busy}) {
+                uint32_t begin = clock.micros();
+                task->run(begin);
+                profiler.record(firefly::Tier::background, round - last_round, clock.micros() - begin);
+            }
+            last_round = round;
+        }
+    }
+
+    const char* name = tiered ? "tiered" : "round robin";
+    char label[64];
+    for (firefly::Tier tier : {firefly::Tier::realtime, firefly::Tier::background}) {
+        const firefly::TierStats& stats = profiler.get(tier);
+        const char* tier_name = tier == firefly::Tier::realtime ? "realtime" : "background";
+        uint32_t runs = stats.runs ? stats.runs : 1;
+        std::snprintf(label, sizeof(label), "%s %s latency avg", name, tier_name);
+        bench::report("scheduler", label, (double)stats.latency_total / runs, "us");
+        std::snprintf(label, sizeof(label), "%s %s latency max", name, tier_name);
+        bench::report("scheduler", label, stats.latency_max, "us");
+    }
+}
+
+}
+
+
+BENCHMARK(scheduler) {
+    run(false);
+    run(true);
+}
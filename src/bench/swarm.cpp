@@ -0,0 +1,81 @@
+// Moving fireflies: how long a whole frame of a Swarm takes with more and
+// more fireflies on a 300 LED strip, against a pinned Jar of the same
+// strip, and how much of the frame period that is.
+
+#include <memory>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+class NullSink : public firefly::OutputSink {
+  public:
+    void set_pixel(uint16_t, uint32_t rgb) override { bench::keep(rgb); }
+    void show() override {}
+};
+
+
+// How many 1 ms frames each measurement runs for.
+const uint32_t FRAMES = 5000;
+const size_t LEDS = 300;
+
+
+void frame(const char* label, double ns) {
+    bench::report("swarm", label, ns / 1000, "us/frame");
+    char budget[64];
+    std::snprintf(budget, sizeof(budget), "%s, of frame period", label);
+    bench::report("swarm", budget, ns / 10 / FIREFLY_FRAME_PERIOD_US, "%");
+}
+
+
+template <size_t M>
+void swarm() {
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(1);
+    auto swarm = std::make_unique<firefly::Swarm<LEDS, M>>(sink, clock, rng);
+    swarm->begin();
+
+    double ns = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            clock.advance(1000);
+            swarm->update();
+        }
+    }, FRAMES);
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "Swarm<%zu, %zu>", LEDS, M);
+    frame(label, ns);
+}
+
+
+void jar() {
+    NullSink sink;
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(1);
+    auto jar = std::make_unique<firefly::Jar<LEDS>>(sink, clock, rng);
+    jar->begin();
+
+    double ns = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            clock.advance(1000);
+            jar->update();
+        }
+    }, FRAMES);
+
+    char label[64];
+    std::snprintf(label, sizeof(label), "Jar<%zu> (pinned)", LEDS);
+    frame(label, ns);
+}
+
+}
+
+
+BENCHMARK(swarm) {
+    jar();
+    swarm<100>();
+    swarm<300>();
+    swarm<1000>();
+}
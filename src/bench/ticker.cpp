@@ -0,0 +1,121 @@
+// Frame ticks from a thread standing in for the timer interrupt, through
+// the FrameTicker's queue and the Scheduler, with slow background work
+// in the way. Reports how late frames start, and checks that every tick
+// arrived exactly once and in order.
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+#include <firefly.hpp>
+#include <firefly/host.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+// Renders nothing, just checks the ticks it's given add up.
+class CheckTask : public firefly::Task {
+  public:
+    uint32_t frames = 0;
+
+    void run(uint32_t) override { this->frames++; }
+};
+
+
+class BusyTask : public firefly::Task {
+  private:
+    firefly::Clock& clock;
+
+  public:
+    explicit BusyTask(firefly::Clock& clock) : clock(clock) {}
+
+    void run(uint32_t now) override {
+        while (this->clock.micros() - now < 300) {
+        }
+    }
+};
+
+
+// The queue on its own: the producer pushes a counter as fast as it
+// can, the consumer checks every value arrives once and in order.
+void queue_order() {
+    const uint32_t ITEMS = 1000000;
+    firefly::SpscQueue<uint32_t, 8> queue;
+    uint32_t errors = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < ITEMS;) {
+            if (queue.push(i)) {
+                i++;
+            } else {
+                // Only one core may be available.
+                std::this_thread::yield();
+            }
+        }
+    });
+    for (uint32_t expected = 0; expected < ITEMS;) {
+        uint32_t value;
+        if (queue.pop(value)) {
+            errors += value != expected;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    bench::report("ticker", "spsc queue handoff", ns / ITEMS, "ns/item");
+    bench::report("ticker", "spsc queue out of order", errors, "items");
+}
+
+
+void ticked_frames() {
+    const uint32_t FRAMES = 2000;
+    firefly::host::SteadyClock clock;
+    firefly::FrameTicker ticker(FIREFLY_FRAME_PERIOD_US);
+    firefly::Profiler profiler;
+    firefly::Scheduler scheduler(clock, profiler);
+    CheckTask check;
+    BusyTask busy(clock);
+
+    scheduler.add_realtime(check, ticker);
+    scheduler.add_background(busy, 350);
+
+    std::atomic<bool> done(false);
+    std::thread timer([&] {
+        auto next = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < FRAMES; i++) {
+            next += std::chrono::microseconds(FIREFLY_FRAME_PERIOD_US);
+            std::this_thread::sleep_until(next);
+            ticker.tick(clock.micros());
+        }
+        done = true;
+    });
+    while (!done) {
+        scheduler.loop();
+        std::this_thread::yield();
+    }
+    timer.join();
+    // Catch the last tick or two.
+    for (int i = 0; i < 10; i++) {
+        scheduler.loop();
+    }
+
+    const firefly::TierStats& stats = profiler.get(firefly::Tier::realtime);
+    bench::report("ticker", "frame start latency avg", (double)stats.latency_total / stats.runs, "us");
+    bench::report("ticker", "frame start latency max", stats.latency_max, "us");
+    bench::report("ticker", "ticks accounted for",
+                  check.frames + ticker.get_missed() + ticker.get_dropped(), "of 2000");
+    bench::report("ticker", "ticks missed", ticker.get_missed(), "ticks");
+}
+
+}
+
+
+BENCHMARK(ticker) {
+    queue_order();
+    ticked_frames();
+}
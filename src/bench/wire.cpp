@@ -0,0 +1,138 @@
+// Going from firefly brightness to the bytes that go out to the strip:
+// packed straight into the strip's buffer by the compositor, against
+// through OutputSink::set_pixel() into Adafruit_NeoPixel's setPixelColor(),
+// and against the float compute_rgb() the jar used before color tables.
+// Every LED changes every frame, so every byte is touched every time.
+
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <memory>
+#include <vector>
+
+#include <firefly.hpp>
+
+#include "bench.hpp"
+
+namespace {
+
+const size_t LEDS = 300;
+const uint32_t FRAMES = 20000;
+
+
+/*!
+    @brief The bits of Adafruit_NeoPixel that setPixelColor() touches.
+*/
+class Strip {
+  private:
+    uint8_t r_offset, g_offset, b_offset;
+    uint8_t brightness;
+
+  public:
+    std::vector<uint8_t> pixels;
+
+    explicit Strip(uint8_t order)
+        : r_offset((order >> 4) & 3), g_offset((order >> 2) & 3), b_offset(order & 3),
+          brightness(0), pixels(3 * LEDS) {}
+
+    void setPixelColor(uint16_t n, uint32_t c) {
+        if (n < LEDS) {
+            uint8_t r = (uint8_t)(c >> 16), g = (uint8_t)(c >> 8), b = (uint8_t)c;
+            if (this->brightness) {
+                r = (r * this->brightness) >> 8;
+                g = (g * this->brightness) >> 8;
+                b = (b * this->brightness) >> 8;
+            }
+            uint8_t* p = &this->pixels[n * 3];
+            p[this->r_offset] = r;
+            p[this->g_offset] = g;
+            p[this->b_offset] = b;
+        }
+    }
+};
+
+
+class StripSink : public firefly::OutputSink {
+  private:
+    Strip& strip;
+
+  public:
+    explicit StripSink(Strip& strip) : strip(strip) {}
+    void set_pixel(uint16_t index, uint32_t rgb) override { this->strip.setPixelColor(index, rgb); }
+    void show() override { bench::keep(this->strip.pixels); }
+};
+
+
+class WireSink : public firefly::OutputSink {
+  private:
+    Strip& strip;
+    firefly::Wire wire;
+
+  public:
+    WireSink(Strip& strip, uint8_t order) : strip(strip), wire{strip.pixels.data(), order, nullptr} {}
+    void set_pixel(uint16_t index, uint32_t rgb) override { this->wire.pack(index, rgb); }
+    void show() override { bench::keep(this->strip.pixels); }
+    const firefly::Wire* get_wire() override { return &this->wire; }
+};
+
+
+uint8_t level(uint32_t frame, size_t index) { return (frame + index) & 0xFF; }
+
+
+/*!
+  @brief A frame's worth through a compositor, at 3/4 brightness.
+*/
+void frames(firefly::Compositor<LEDS>& compositor) {
+    const firefly::Species& species = firefly::species::p_pyralis;
+    for (uint32_t f = 0; f < FRAMES; f++) {
+        for (size_t i = 0; i < LEDS; i++) {
+            compositor.put(i, species, level(f, i));
+        }
+        compositor.show();
+    }
+}
+
+
+void report(const char* label, double ns) {
+    // Nanoseconds a frame to bytes a microsecond.
+    bench::report("wire", label, 3 * LEDS * 1000 / ns, "bytes/us");
+}
+
+}
+
+
+BENCHMARK(wire) {
+    Strip through(firefly::order::bgr), direct(firefly::order::bgr), floats(firefly::order::bgr);
+    StripSink strip_sink(through);
+    WireSink wire_sink(direct, firefly::order::bgr);
+    auto set_pixel = std::make_unique<firefly::Compositor<LEDS>>(strip_sink);
+    auto packed = std::make_unique<firefly::Compositor<LEDS>>(wire_sink);
+    for (auto* compositor : {set_pixel.get(), packed.get()}) {
+        compositor->clear();
+        compositor->set_brightness(191);
+    }
+
+    // Both ways should leave the same bytes for the strip.
+    frames(*set_pixel);
+    frames(*packed);
+    if (std::memcmp(through.pixels.data(), direct.pixels.data(), 3 * LEDS) != 0) {
+        std::printf("wire: packed bytes don't match setPixelColor()'s\n");
+        std::exit(1);
+    }
+
+    double old = bench::measure([&] {
+        for (uint32_t f = 0; f < FRAMES; f++) {
+            for (size_t i = 0; i < LEDS; i++) {
+                uint8_t scaled = (level(f, i) * 192) >> 8;
+                floats.setPixelColor(i, firefly::compute_rgb(scaled, 0.788, 1.0, 0.0));
+            }
+            bench::keep(floats.pixels);
+        }
+    }, FRAMES);
+    double through_sink = bench::measure([&] { frames(*set_pixel); }, FRAMES);
+    double fused = bench::measure([&] { frames(*packed); }, FRAMES);
+
+    report("compute_rgb, setPixelColor", old);
+    report("Compositor, setPixelColor", through_sink);
+    report("Compositor, packed", fused);
+}
@@ -0,0 +1,203 @@
+/*
+On-device benchmarks for the firefly engine.
+
+Flash this with `pio run -e nodemcuv2_bench -t upload -t monitor`. It
+doesn't drive any LEDs, it just runs each flash implementation for a
+couple of seconds (and times a few smaller pieces, like reading the
+clock and sampling noise) and prints how long it took over serial. These are
+the numbers that matter; the host benchmarks in src/bench only tell
+you which way things lean.
+
+`pio run -e nodemcuv2_bench_iram -t upload -t monitor` runs the same with
+the hot functions in IRAM (see FIREFLY_HOT), to compare the two.
+*/
+
+#include <Arduino.h>
+#include <initializer_list>
+
+#include <firefly.hpp>
+#include <firefly/arduino.hpp>
+#include <firefly/flash/ace_routine_flash.hpp>
+#include <firefly/flash/switch_flash.hpp>
+
+namespace {
+
+// How long each measurement runs for, in milliseconds.
+const uint32_t RUN_MS = 2000;
+
+// Host and device use different randomness for the jar, but here
+// we want every implementation to get the same timings.
+firefly::XorShiftRng rng(1);
+
+
+// Give the Firefly the same resume(now) shape as the stepped ones.
+class AnalyticFlash : public firefly::Firefly {
+  private:
+    firefly::Timing timing;
+
+  public:
+    AnalyticFlash(const firefly::Species& species, firefly::Rng& rng)
+        : firefly::Firefly(0, species), timing(firefly::Timing::of(species)) {
+        this->begin(micros64(), rng, this->timing);
+    }
+
+    void resume(uint64_t now) { this->update(now, rng, this->timing); }
+};
+
+
+/*!
+    @param bytes  What each firefly costs: for Firefly, just the Firefly,
+           since its Timing is one per jar.
+*/
+template <typename Flash, size_t N>
+void suite(const char* name, size_t bytes = sizeof(Flash)) {
+    // Static, since some of these don't fit on the stack.
+    static Flash* jar[N];
+    for (size_t i = 0; i < N; i++) {
+        jar[i] = new Flash(firefly::species::p_pyralis, rng);
+    }
+
+    uint32_t loops = 0;
+    uint32_t cycles = 0;
+    uint32_t start = millis();
+    while (millis() - start < RUN_MS) {
+        uint32_t begin = ESP.getCycleCount();
+        uint64_t now = micros64();
+        for (size_t i = 0; i < N; i++) {
+            jar[i]->resume(now);
+        }
+        cycles += ESP.getCycleCount() - begin;
+        loops++;
+        // Keep the watchdog happy.
+        yield();
+    }
+
+    for (size_t i = 0; i < N; i++) {
+        delete jar[i];
+    }
+
+    Serial.printf("%-16s x%-4u %4u bytes/firefly %8.2f us/loop %8.0f cycles/firefly\n",
+                  name, (unsigned)N, (unsigned)bytes,
+                  cycles / (float)loops / ESP.getCpuFreqMHz(), cycles / (float)loops / N);
+}
+
+
+
+/*!
+    @brief What reading the time costs, raw and stretched to 64 bits.
+*/
+void clock_reads() {
+    const uint32_t READS = 10000;
+    firefly::arduino::MicrosClock clock;
+    firefly::Clock& base = clock;
+    volatile uint64_t sink;
+
+    uint32_t begin = ESP.getCycleCount();
+    for (uint32_t i = 0; i < READS; i++) {
+        sink = base.micros();
+    }
+    uint32_t raw = ESP.getCycleCount() - begin;
+
+    begin = ESP.getCycleCount();
+    for (uint32_t i = 0; i < READS; i++) {
+        sink = base.now();
+    }
+    uint32_t extended = ESP.getCycleCount() - begin;
+    (void)sink;
+
+    Serial.printf("Clock::micros() %6.1f cycles/read\n", raw / (float)READS);
+    Serial.printf("Clock::now()    %6.1f cycles/read\n", extended / (float)READS);
+}
+
+
+
+class NullSink : public firefly::OutputSink {
+  public:
+    void set_pixel(uint16_t, uint32_t) override {}
+    void show() override {}
+};
+
+
+/*!
+    @brief What a whole frame of the jar costs: back to back, with its
+           code still in the cache from the last one, and then with the
+           rest of a loop (WiFi, serial and so on, which is what delay()
+           gives time to) in between to push it out again.
+*/
+void jar_frames() {
+    static NullSink sink;
+    static firefly::arduino::MicrosClock clock;
+    static firefly::Jar<10> jar(sink, clock, rng);
+    jar.set_flicker(32);
+    jar.begin();
+
+    for (bool busy : {false, true}) {
+        uint32_t frames = 0;
+        uint32_t cycles = 0;
+        uint32_t worst = 0;
+        uint32_t start = millis();
+        while (millis() - start < RUN_MS) {
+            uint32_t begin = ESP.getCycleCount();
+            jar.update();
+            uint32_t took = ESP.getCycleCount() - begin;
+            cycles += took;
+            worst = took > worst ? took : worst;
+            frames++;
+            if (busy) {
+                delay(1);
+            } else {
+                yield();
+            }
+        }
+        Serial.printf("Jar<10>::update %s %8.2f us/frame %8.2f us worst\n",
+                      busy ? "in a busy loop" : "back to back  ",
+                      cycles / (float)frames / ESP.getCpuFreqMHz(), worst / (float)ESP.getCpuFreqMHz());
+    }
+}
+
+
+
+/*!
+    @brief What one sample of the flicker's noise costs.
+*/
+void noise_samples() {
+    const uint32_t SAMPLES = 10000;
+    volatile uint8_t sink;
+
+    uint32_t x = 0;
+    uint32_t begin = ESP.getCycleCount();
+    for (uint32_t i = 0; i < SAMPLES; i++) {
+        sink = firefly::noise::sample(x);
+        x += 0x9E;
+    }
+    uint32_t cycles = ESP.getCycleCount() - begin;
+    (void)sink;
+
+    Serial.printf("noise::sample   %6.1f cycles/sample\n", cycles / (float)SAMPLES);
+}
+
+}
+
+
+void setup() {
+    Serial.begin(115200);
+    delay(1000);
+    Serial.println();
+    Serial.printf("hot functions in %s, frame loops in %s\n",
+                  FIREFLY_HOT_IRAM ? "IRAM" : "flash", FIREFLY_HOT_IRAM >= 2 ? "IRAM" : "flash");
+    clock_reads();
+    noise_samples();
+    jar_frames();
+
+    Serial.println("firefly flash implementations");
+
+    suite<AnalyticFlash, 10>("Firefly", sizeof(firefly::Firefly));
+    suite<firefly::flash::SwitchFlash, 10>("SwitchFlash");
+    suite<firefly::flash::AceRoutineFlash, 10>("AceRoutineFlash");
+    suite<AnalyticFlash, 100>("Firefly", sizeof(firefly::Firefly));
+    suite<firefly::flash::SwitchFlash, 100>("SwitchFlash");
+    suite<firefly::flash::AceRoutineFlash, 100>("AceRoutineFlash");
+}
+
+
+void loop() {}
@@ -26,50 +26,248 @@ primary objectives with this:
 #1 is pretty easy using the ESP8266TrueRandom library.
 #2 is a bit more difficult since we're trying to control multiple LEDs
 independently, and at the same time. Multithreading? Sure, but not on
-an ESP8266, they're too small and dumb. So instead we have to use
-coroutines. If you know what coroutines are, I don't have to explain
-myself, and if you don't: good. Avoid them.
-
-(If you really care, look it up. I'm not going to do anyone any
-service by explaining it in the comments here.)
+an ESP8266, they're too small and dumb. So instead each firefly is a
+little state machine which works out its brightness from how long it's
+been in its current phase. The whole thing lives in lib/firefly, which
+doesn't know anything about the Arduino, so that it can also be run
+on a normal computer. This file just hooks it up to the real hardware.
 */
 
+#include <AceRoutine.h>
 #include <Adafruit_NeoPixel.h>
 #include <Arduino.h>
-#include <vector>
 
 #include <firefly.hpp>
+#include <firefly/arduino.hpp>
 
 // Output pin for NeoPixels. D2 is GPIO4 on the ESP8266.
 #define PIN       D2
-// We define the number of "fireflies" we have in the jar.
-#define NUMPIXELS 10
+// OneWire bus for an (optional) DS18B20 thermometer. D5 is GPIO14.
+#define TEMPERATURE_PIN D5
+// We define the number of "fireflies" we have in the jar. This is
+// a compile time constant; the jar refuses to compile if it's too big.
+constexpr uint16_t NUMPIXELS = 10;
 
 // Define the pixels. Some of these might need to be changed,
 // depending on your specific use. In particular, NEO_BGR defines
 // a blue-green-red channel order. Other LEDs might be different.
 Adafruit_NeoPixel pixels(NUMPIXELS, PIN, NEO_BGR + NEO_KHZ800);
 
-// Vector to hold our fireflies.
-std::vector<Firefly *> jar;
+// Build with -DFIREFLY_CALIBRATION to correct the LEDs one by one, for
+// strips where some look brighter or a different tint than the rest (or
+// have their channels the other way round). Every LED starts out as is;
+// change the ones that stand out, e.g. calibration[3].blue = 200.
+#ifdef FIREFLY_CALIBRATION
+std::array<firefly::LedCalibration, NUMPIXELS> calibration = firefly::uncalibrated<NUMPIXELS>(firefly::order::bgr);
+#endif
+
+// The hardware the jar runs on. Randomness from the radio is slow
+// to come by, so it's pooled up in the background ahead of time.
+#ifdef FIREFLY_CALIBRATION
+firefly::arduino::NeoPixelSink sink(pixels, NEO_BGR, calibration.data());
+#else
+firefly::arduino::NeoPixelSink sink(pixels, NEO_BGR);
+#endif
+firefly::arduino::MicrosClock clock_source;
+firefly::arduino::TrueRandomRng true_random;
+firefly::PooledRng rng(true_random);
+
+// And the jar to hold our fireflies.
+firefly::Jar<NUMPIXELS> jar(sink, clock_source, rng);
+
+// Everything that runs in the loop goes through the scheduler. Drawing
+// the jar is real-time, everything else fits around it.
+firefly::Profiler profiler;
+firefly::Scheduler scheduler(clock_source, profiler);
+firefly::arduino::SerialSink serial_sink;
+firefly::Telemetry telemetry(serial_sink);
+firefly::arduino::AceRoutineTask coroutines;
+
+// Fireflies flash faster when it's warm. Without a thermometer on the
+// bus, readings never arrive and the jar just stays at its species'
+// reference temperature.
+firefly::arduino::Ds18b20Sensor thermometer(TEMPERATURE_PIN);
+firefly::TemperatureTask<firefly::Jar<NUMPIXELS>> temperature_task(thermometer, jar);
+
+// Build with -DFIREFLY_LIGHT_SENSOR, with a photoresistor on A0, to have
+// the jar dim itself in a dark room and switch off in daylight. It's
+// left out otherwise, since an unconnected A0 reads whatever it likes.
+#ifdef FIREFLY_LIGHT_SENSOR
+firefly::arduino::PhotoresistorSensor light_sensor;
+firefly::LightTask<firefly::Jar<NUMPIXELS>> light_task(light_sensor, jar);
+#endif
+
+// Build with -DFIREFLY_COURTSHIP to make a fifth of the fireflies
+// female: they hardly flash on their own, but answer the others.
+#ifdef FIREFLY_COURTSHIP
+firefly::EventBus flashes(clock_source);
+#endif
+
+// Build with -DFIREFLY_PREDATOR as well to hide a Photuris among the
+// females, who eats some of the males she lures.
+#ifdef FIREFLY_PREDATOR
+#ifndef FIREFLY_COURTSHIP
+#error "FIREFLY_PREDATOR needs FIREFLY_COURTSHIP, for females to hide among"
+#endif
+firefly::Predator<firefly::Jar<NUMPIXELS>> predator(jar, flashes, clock_source, rng, 1);
+#endif
+
+// Build with -DFIREFLY_POPULATION to have fireflies come and go over
+// the evening, starting with half the jar. Not with FIREFLY_PREDATOR.
+#ifdef FIREFLY_POPULATION
+#ifdef FIREFLY_PREDATOR
+#error "FIREFLY_POPULATION and FIREFLY_PREDATOR both hold fireflies out of the jar, use one"
+#endif
+firefly::Population<firefly::Jar<NUMPIXELS>> population(jar, clock_source, rng, NUMPIXELS / 2);
+#endif
+
+// Build with -DFIREFLY_TIMER_TICK to have timer1 decide when frames
+// start, rather than however fast loop() happens to be going around.
+#ifdef FIREFLY_TIMER_TICK
+firefly::FrameTicker ticker(FIREFLY_FRAME_PERIOD_US);
+#endif
+
+// Build with -DFIREFLY_DEEP_SLEEP as well as -DFIREFLY_TIMELINE to have
+// the ESP8266 sleep through the quiet hours, rather than draw an empty
+// jar all day. Wire D0 (GPIO16) to RST, so the timer can wake it. The jar
+// is kept in RTC memory in the meantime, and carries on where it left off.
+#ifdef FIREFLY_DEEP_SLEEP
+#ifndef FIREFLY_TIMELINE
+#error "FIREFLY_DEEP_SLEEP needs FIREFLY_TIMELINE, to know when it's quiet"
+#endif
+#if defined(FIREFLY_PREDATOR) || defined(FIREFLY_POPULATION)
+#error "FIREFLY_DEEP_SLEEP can't keep a Predator's catches or a Population over sleep"
+#endif
+// Not worth going to sleep for less than a minute.
+#define FIREFLY_MIN_SLEEP_US 60000000ull
+firefly::Jar<NUMPIXELS>::Checkpoint checkpoint;
+#endif
+
+
+/*!
+    @brief Queue the profiler's numbers up to go out over serial.
+*/
+void report() {
+    char buffer[256];
+    size_t length = profiler.report(buffer, sizeof(buffer));
+    telemetry.write(buffer, length);
+}
+
+
+/*!
+    @brief Every ten seconds, report how the scheduler is doing.
+*/
+class ReportTask : public firefly::Task {
+  private:
+    uint32_t last = 0;
+
+  public:
+    void run(uint32_t now) override {
+        if (now - this->last >= 10000000) {
+            this->last = now;
+            report();
+        }
+    }
+} report_task;
+
+
+/*!
+    @brief A tiny serial console. Send 'p' to get the profiler's
+           numbers right away, or 'r' to start counting again.
+*/
+COROUTINE(console) {
+    COROUTINE_LOOP() {
+        COROUTINE_AWAIT(Serial.available() > 0);
+        int c = Serial.read();
+        if (c == 'p') {
+            report();
+        } else if (c == 'r') {
+            profiler.reset();
+            telemetry.write("profiler reset\n");
+        }
+    }
+}
+
 
 /*!
     @brief Setup function. This runs once before the microcontroller
            enters the main loop.
 */
 void setup() {
+    Serial.begin(115200);
+
     // Initialize pixels.
     pixels.begin();
-    
-    // Start by turning all of our pixels off, and then
-    // create a new Firefly for each one, pushing it
-    // into the "jar" vector.
-    for (int i=0; i<NUMPIXELS; i++) {
-        pixels.setPixelColor(i, pixels.Color(0, 0, 0));
-        pixels.show();
-
-        jar.push_back(new Firefly(i, pixels));
+
+    thermometer.begin();
+
+    // Have some randomness ready before the first firefly needs it.
+    while (rng.available() < FIREFLY_RNG_POOL) {
+        rng.run(0);
     }
+
+#ifdef FIREFLY_COURTSHIP
+    jar.set_courtship(flashes, NUMPIXELS / 5);
+#endif
+
+    // A touch of flicker, so the glow looks alive.
+    jar.set_flicker(32);
+    // And a short afterglow, so flashes fade out rather than snap off.
+    jar.set_afterglow(30);
+
+    // Turn all of our pixels off, and put a firefly on each one.
+    jar.begin();
+#ifdef FIREFLY_PREDATOR
+    predator.begin();
+#endif
+#ifdef FIREFLY_POPULATION
+    population.begin();
+#endif
+
+    // Build with -DFIREFLY_TIMELINE to have the jar act out an evening,
+    // counting from when it's switched on (so put it on a timer that
+    // comes on at dusk), and repeat it every day after that.
+#ifdef FIREFLY_TIMELINE
+    static const firefly::Timeline evening(firefly::timelines::p_pyralis_evening);
+    jar.set_timeline(evening, clock_source.now());
+#endif
+
+    // Only on waking from deep sleep: after a reset or a power cut, the
+    // evening starts over. If RTC memory doesn't hold a checkpoint, the
+    // jar just starts fresh.
+#ifdef FIREFLY_DEEP_SLEEP
+    if (ESP.getResetInfoPtr()->reason == REASON_DEEP_SLEEP_AWAKE
+        && ESP.rtcUserMemoryRead(0, (uint32_t*)&checkpoint, sizeof(checkpoint))) {
+        jar.restore(checkpoint);
+    }
+#endif
+
+    // The slices are generous guesses at how long each one takes.
+#ifdef FIREFLY_TIMER_TICK
+    scheduler.add_realtime(jar, ticker);
+    firefly::arduino::start_timer1(ticker);
+#else
+    scheduler.add_realtime(jar, FIREFLY_FRAME_PERIOD_US);
+#endif
+#ifdef FIREFLY_COURTSHIP
+    scheduler.add_realtime(flashes, FIREFLY_FRAME_PERIOD_US);
+#endif
+    scheduler.add_background(rng, 100);
+    scheduler.add_background(telemetry, 100);
+    scheduler.add_background(coroutines, 50);
+    scheduler.add_background(report_task, 300);
+    // One bit of the OneWire bus at a time (see Ds18b20Sensor).
+    scheduler.add_background(temperature_task, 100);
+#ifdef FIREFLY_LIGHT_SENSOR
+    scheduler.add_background(light_task, 200);
+#endif
+#ifdef FIREFLY_PREDATOR
+    scheduler.add_background(predator, 50);
+#endif
+#ifdef FIREFLY_POPULATION
+    scheduler.add_background(population, 50);
+#endif
+    ace_routine::CoroutineScheduler::setup();
 }
 
 
@@ -78,9 +276,23 @@ void setup() {
            as fast as the microcontroller can run it.
 */
 void loop() {
-    // For each firefly in our jar, we want to run its coroutine
-    // defined in firefly.hpp.
-    for (auto firefly : jar) {
-        firefly->runCoroutine();
+    scheduler.loop();
+
+    // In daylight there's nothing to draw, so let the ESP8266 doze
+    // between looks at the light sensor.
+    if (jar.is_paused()) {
+        delay(10);
     }
-}
\ No newline at end of file
+
+    // Once nobody's out, and nobody will be for a while, sleep until
+    // they are (or for as long as the ESP8266 can, and then again).
+#ifdef FIREFLY_DEEP_SLEEP
+    uint64_t quiet = jar.get_quiet_us();
+    if (quiet >= FIREFLY_MIN_SLEEP_US) {
+        uint64_t sleep = std::min<uint64_t>(quiet, ESP.deepSleepMax());
+        jar.save(checkpoint, sleep);
+        ESP.rtcUserMemoryWrite(0, (uint32_t*)&checkpoint, sizeof(checkpoint));
+        ESP.deepSleep(sleep);
+    }
+#endif
+}
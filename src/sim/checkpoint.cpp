@@ -0,0 +1,159 @@
+// Checkpoints: a jar run a frame at a time through a short day, against
+// one restored from a checkpoint of it halfway through the evening (on a
+// clock that started somewhere else), and one restored from a checkpoint
+// saved to sleep through the quiet hours, the way the ESP8266 does in deep
+// sleep. Every firefly and LED has to match the jar that never stopped.
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <memory>
+
+#include "sim.hpp"
+
+namespace {
+
+// As many as fit RTC memory, with room to spare.
+const size_t N = 20;
+using Jar = firefly::Jar<N>;
+
+using Clock = std::chrono::steady_clock;
+
+double us_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// A forty minute day, so the quiet hours come round quickly: busy for
+// twenty minutes, then nobody.
+const firefly::Keyframe day[] = {
+    {0, 128},
+    {10, 255},
+    {20, 0},
+};
+
+/*!
+    @brief A jar and everything it runs on, restored from a checkpoint.
+*/
+struct Restored {
+    sim::MemorySink sink{N};
+    firefly::ManualClock clock;
+    // Seeded differently on purpose: where it's got to comes from the
+    // checkpoint.
+    firefly::CounterRng rng{0};
+    Jar jar{sink, clock, rng};
+    double restore_us = 0;
+
+    Restored(uint32_t start, const firefly::Timeline& timeline, const Jar::Checkpoint& checkpoint) : clock(start) {
+        this->jar.begin();
+        this->jar.set_timeline(timeline, 0);
+        auto begin = Clock::now();
+        bool restored = this->jar.restore(checkpoint);
+        this->restore_us = us_since(begin);
+        if (!restored) {
+            std::printf("checkpoint was turned down\n");
+        }
+    }
+};
+
+unsigned long compare(const Jar& a, const sim::MemorySink& a_sink, const Jar& b, const sim::MemorySink& b_sink) {
+    unsigned long wrong = 0;
+    for (size_t i = 0; i < N; i++) {
+        if (a[i].get_phase() != b[i].get_phase() || a[i].get_brightness() != b[i].get_brightness()
+            || a[i].get_peak() != b[i].get_peak() || a[i].is_visible() != b[i].is_visible()
+            || a.is_active(i) != b.is_active(i) || a_sink.pixels[i] != b_sink.pixels[i]) {
+            wrong++;
+        }
+    }
+    return wrong;
+}
+
+}
+
+
+namespace sim {
+
+int checkpoint(const Options& options) {
+    const uint32_t TICK = 1000;
+    const uint64_t SAVE = 300ull * 1000000;
+
+    static const firefly::Timeline timeline(day, std::size(day), 40);
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::CounterRng rng(options.seed);
+    auto jar = std::make_unique<Jar>(sink, clock, rng);
+    jar->begin();
+    jar->set_timeline(timeline, 0);
+
+    std::unique_ptr<Restored> awake;
+    std::unique_ptr<Restored> slept;
+    uint64_t wake = 0;
+    unsigned long frames = 0;
+    unsigned long different = 0;
+    int failed = 0;
+
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    for (uint64_t t = TICK; t <= end; t += TICK) {
+        clock.advance(TICK);
+        jar->update();
+
+        if (awake) {
+            awake->clock.advance(TICK);
+            awake->jar.update();
+            different += compare(*jar, sink, awake->jar, awake->sink);
+            frames++;
+        }
+        if (slept && t > wake) {
+            slept->clock.advance(TICK);
+            slept->jar.update();
+            different += compare(*jar, sink, slept->jar, slept->sink);
+            frames++;
+        }
+
+        if (t == SAVE) {
+            Jar::Checkpoint checkpoint;
+            auto begin = Clock::now();
+            jar->save(checkpoint);
+            double save_us = us_since(begin);
+
+            // On a clock nowhere near this one, a minute off wrapping.
+            awake = std::make_unique<Restored>(0xFFFFFFFFu - 60000000u, timeline, checkpoint);
+            Jar::Checkpoint again;
+            awake->jar.save(again);
+            bool same = std::memcmp(&checkpoint, &again, sizeof(checkpoint)) == 0;
+            different += compare(*jar, sink, awake->jar, awake->sink);
+
+            // And one that's been knocked about shouldn't be taken.
+            Jar::Checkpoint corrupt = checkpoint;
+            corrupt.fireflies[3].since ^= 1;
+            bool turned_down = !awake->jar.restore(corrupt);
+
+            std::printf("%zu byte checkpoint at minute %llu: saved in %.1f us, restored in %.1f us, %s, %s\n",
+                        sizeof(checkpoint), (unsigned long long)(t / 60000000), save_us, awake->restore_us,
+                        same ? "saves the same again" : "SAVES DIFFERENTLY", turned_down ? "corruption caught" : "CORRUPTION MISSED");
+            failed |= !same || !turned_down;
+        }
+
+        uint64_t quiet = slept ? 0 : jar->get_quiet_us();
+        if (quiet) {
+            // Sleep through to the next evening, in whole frames, and
+            // wake on a clock that starts at 0, as the ESP8266's does.
+            uint64_t sleep = (quiet + TICK - 1) / TICK * TICK;
+            Jar::Checkpoint checkpoint;
+            jar->save(checkpoint, sleep);
+            wake = t + sleep;
+            slept = std::make_unique<Restored>(0, timeline, checkpoint);
+            std::printf("quiet at minute %.1f, slept %.1f minutes, restored in %.1f us\n",
+                        t / 60e6, sleep / 60e6, slept->restore_us);
+        }
+    }
+
+    if (!slept || wake >= end) {
+        std::printf("never woke up: run for longer\n");
+        failed = 1;
+    }
+    std::printf("%lu frames compared, %lu fireflies different\n", frames, different);
+    return failed || different ? 1 : 0;
+}
+
+}
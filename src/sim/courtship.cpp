@@ -0,0 +1,134 @@
+// Males and females on an event bus. Reports how many flash events went
+// through the bus and how long they waited to be delivered, and checks
+// that the females really are answering: they should flash far more
+// often than they would on their own, and nearly always the species'
+// answer delay after some male.
+
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace {
+
+const size_t N = 50;
+const uint16_t FEMALES = 10;
+const uint32_t TICK = 1000;
+
+
+/*!
+    @brief Remembers when every male flash was published.
+*/
+class Recorder : public firefly::Listener {
+  public:
+    std::vector<uint64_t> flashes;
+
+    void on_flash(const firefly::FlashEvent& event, uint64_t) override {
+        this->flashes.push_back(event.time);
+    }
+};
+
+
+struct Result {
+    unsigned long female_flashes;
+    // Female flashes that came the answer delay after a male flash.
+    unsigned long timed;
+    uint32_t answers;
+    uint32_t published;
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t latency_max;
+    double latency_mean;
+};
+
+
+Result court(const sim::Options& options) {
+    const firefly::Species& species = firefly::species::p_pyralis;
+    // Answers are timed from the event, which is published on the frame
+    // the flash was seen, so allow a couple of frames either way.
+    const uint64_t EARLIEST = species.answer_min_ms * 1000ull - 2 * TICK;
+    const uint64_t LATEST = species.answer_max_ms * 1000ull + 2 * TICK;
+
+    sim::MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    firefly::Jar<N> jar(sink, clock, rng);
+    firefly::EventBus bus(clock);
+    Recorder recorder;
+
+    jar.set_courtship(bus, FEMALES);
+    bus.subscribe(recorder);
+    jar.begin();
+
+    std::vector<firefly::Phase> phase(N, firefly::Phase::rising);
+    Result result = {};
+    size_t oldest = 0;
+
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    for (uint64_t t = 0; t < end; t += TICK) {
+        clock.advance(TICK);
+        // The bus runs before the jar, as if it were added to the
+        // scheduler first, so events wait about a frame.
+        bus.dispatch(clock.now());
+        jar.update();
+
+        for (size_t i = 0; i < FEMALES; i++) {
+            firefly::Phase now = jar[i].get_phase();
+            if (phase[i] == firefly::Phase::dark && now == firefly::Phase::rising && jar[i].is_visible()) {
+                result.female_flashes++;
+                while (oldest < recorder.flashes.size() && recorder.flashes[oldest] + LATEST < t) {
+                    oldest++;
+                }
+                for (size_t e = oldest; e < recorder.flashes.size(); e++) {
+                    uint64_t since = t - recorder.flashes[e];
+                    if (since >= EARLIEST && since <= LATEST) {
+                        result.timed++;
+                        break;
+                    }
+                }
+            }
+            phase[i] = now;
+        }
+    }
+
+    result.answers = jar.get_answers();
+    result.published = bus.get_published();
+    result.delivered = bus.get_delivered();
+    result.dropped = bus.get_dropped();
+    result.latency_max = bus.get_latency_max();
+    result.latency_mean = result.delivered ? (double)bus.get_latency_total() / result.delivered : 0;
+    return result;
+}
+
+}
+
+
+namespace sim {
+
+int courtship(const Options& options) {
+    const firefly::Species& species = firefly::species::p_pyralis;
+    Result on = court(options);
+    double seconds = options.seconds;
+
+    // On her own, a female waits eight times the usual dark between
+    // flashes, and only every other flash is visible.
+    double dark = (species.dark_min_ms + species.dark_max_ms - 1) / 2.0 * 8 / 1000;
+    double alone = FEMALES * seconds / dark / 2;
+
+    std::printf("%zu fireflies (%u female), %.0f s simulated\n", N, FEMALES, seconds);
+    std::printf("events:  %lu published (%.2f/s), %lu delivered, %lu dropped\n",
+                (unsigned long)on.published, on.published / seconds,
+                (unsigned long)on.delivered, (unsigned long)on.dropped);
+    std::printf("latency: %.1f us mean, %lu us max\n", on.latency_mean, (unsigned long)on.latency_max);
+    std::printf("females: %lu answers, %lu flashes (about %.0f on their own), %.1f%% of them"
+                " an answer delay after a male\n",
+                (unsigned long)on.answers, on.female_flashes, alone,
+                100.0 * on.timed / on.female_flashes);
+
+    bool ok = on.dropped == 0 && on.delivered == on.published
+           && on.female_flashes >= 4 * alone
+           && on.timed >= 0.95 * on.female_flashes;
+    std::printf("%s\n", ok ? "ok" : "WRONG");
+    return ok ? 0 : 1;
+}
+
+}
@@ -0,0 +1,170 @@
+// Every flash's peak brightness and length, measured from the outside and
+// checked against the species' distributions: the peaks should be spread
+// evenly over their range, the step delays should have the mean and
+// spread of a delay stretched by a length, and since the rise and fall of
+// a flash share one length, their step delays should go up and down
+// together by just as much as that predicts.
+
+#include <cmath>
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace {
+
+/*!
+    @brief Running sums for mean, spread and correlation.
+*/
+struct Stats {
+    double n = 0;
+    double x = 0, xx = 0;
+    double y = 0, yy = 0;
+    double xy = 0;
+
+    void add(double a, double b) {
+        n++;
+        x += a;
+        xx += a * a;
+        y += b;
+        yy += b * b;
+        xy += a * b;
+    }
+
+    double mean_x() const { return x / n; }
+    double mean_y() const { return y / n; }
+    double sd_x() const { return std::sqrt(xx / n - mean_x() * mean_x()); }
+    double sd_y() const { return std::sqrt(yy / n - mean_y() * mean_y()); }
+    double correlation() const {
+        return (xy / n - mean_x() * mean_y()) / (sd_x() * sd_y());
+    }
+};
+
+
+/*!
+    @brief Mean and variance of a whole number drawn evenly from [min, max).
+*/
+double mean(double min, double max) { return (min + max - 1) / 2; }
+double variance(double min, double max) { return ((max - min) * (max - min) - 1) / 12; }
+
+
+/*!
+    @brief What one firefly's current flash has done so far.
+*/
+struct Track {
+    firefly::Phase phase;
+    uint64_t entered;
+    uint64_t rise;
+    uint8_t peak;
+    bool whole;
+};
+
+
+bool check(const char* name, double measured, double expected, double tolerance) {
+    bool ok = std::fabs(measured - expected) <= tolerance * std::fabs(expected);
+    std::printf("  %-28s %10.3f %10.3f %s\n", name, measured, expected, ok ? "ok" : "WRONG");
+    return ok;
+}
+
+}
+
+
+namespace sim {
+
+int envelope(const Options& options) {
+    const size_t N = 100;
+    const uint32_t TICK = 1000;
+    const firefly::Species& species = firefly::species::p_pyralis;
+    // Peaks go in this many bins of equal width for the chi-squared test.
+    const unsigned BINS = 8;
+    // Chi-squared with BINS - 1 = 7 degrees of freedom, at p = 0.001.
+    const double CHI_SQUARED = 24.32;
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    firefly::Jar<N> jar(sink, clock, rng);
+
+    jar.begin();
+
+    std::vector<Track> tracks(N, Track{firefly::Phase::rising, 0, 0, 0, false});
+    std::vector<unsigned long> bins(BINS, 0);
+    unsigned long flashes = 0, outside = 0;
+    Stats peaks, delays;
+
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    for (uint64_t t = 0; t < end; t += TICK) {
+        clock.advance(TICK);
+        jar.update();
+
+        for (size_t i = 0; i < N; i++) {
+            const firefly::Firefly& firefly = jar[i];
+            Track& track = tracks[i];
+            uint8_t brightness = firefly.get_brightness();
+            track.peak = brightness > track.peak ? brightness : track.peak;
+            if (firefly.get_phase() == track.phase) {
+                continue;
+            }
+
+            if (track.phase == firefly::Phase::rising) {
+                track.rise = t - track.entered;
+            } else if (track.phase == firefly::Phase::falling && track.whole) {
+                // Each ramp is peak steps of one delay, so the delays
+                // come out of how long the ramps took.
+                uint64_t fall = t - track.entered;
+                flashes++;
+                outside += track.peak < species.peak_min || track.peak >= species.peak_max;
+                bins[(track.peak - species.peak_min) * BINS / (species.peak_max - species.peak_min) % BINS]++;
+                peaks.add(track.peak, 0);
+                delays.add((double)track.rise / track.peak, (double)fall / track.peak);
+            } else if (track.phase == firefly::Phase::dark) {
+                track.whole = true;
+                track.peak = 0;
+            }
+            track.phase = firefly.get_phase();
+            track.entered = t;
+        }
+    }
+
+    double chi_squared = 0;
+    double expected = (double)flashes / BINS;
+    for (unsigned long count : bins) {
+        chi_squared += (count - expected) * (count - expected) / expected;
+    }
+
+    // A step delay is an even draw D times an even draw L / 100, so its
+    // variance is E[D^2] E[L^2] - (E[D] E[L])^2, and the rise and fall
+    // delays of one flash share L, which makes their covariance
+    // E[R] E[F] Var(L).
+    double l = mean(species.length_min_pct, species.length_max_pct) / 100;
+    double ll = variance(species.length_min_pct, species.length_max_pct) / 1e4 + l * l;
+    double r = mean(species.rise_min_us, species.rise_max_us);
+    double rr = variance(species.rise_min_us, species.rise_max_us) + r * r;
+    double f = mean(species.fall_min_us, species.fall_max_us);
+    double ff = variance(species.fall_min_us, species.fall_max_us) + f * f;
+    double sd_rise = std::sqrt(rr * ll - r * r * l * l);
+    double sd_fall = std::sqrt(ff * ll - f * f * l * l);
+    double correlation = r * f * (ll - l * l) / (sd_rise * sd_fall);
+
+    std::printf("%lu flashes from %zu fireflies, %.0f s simulated\n", flashes, N, options.seconds);
+    std::printf("  %-28s %10s %10s\n", "", "measured", "expected");
+    bool ok = true;
+    ok &= check("peak, mean", peaks.mean_x(), mean(species.peak_min, species.peak_max), 0.01);
+    ok &= check("peak, sd", peaks.sd_x(), std::sqrt(variance(species.peak_min, species.peak_max)), 0.03);
+    ok &= check("rise step us, mean", delays.mean_x(), r * l, 0.01);
+    ok &= check("rise step us, sd", delays.sd_x(), sd_rise, 0.05);
+    ok &= check("fall step us, mean", delays.mean_y(), f * l, 0.01);
+    ok &= check("fall step us, sd", delays.sd_y(), sd_fall, 0.05);
+    ok &= check("rise/fall correlation", delays.correlation(), correlation, 0.15);
+
+    bool even = chi_squared < CHI_SQUARED && outside == 0;
+    std::printf("  %-28s %10.3f %10.3f %s\n", "peak chi-squared (< limit)", chi_squared, CHI_SQUARED,
+                even ? "ok" : "WRONG");
+    if (outside) {
+        std::printf("  %lu peaks outside [%u, %u)\n", outside, species.peak_min, species.peak_max);
+    }
+    ok &= even;
+
+    return ok ? 0 : 1;
+}
+
+}
@@ -0,0 +1,118 @@
+// A day's worth of room light, squeezed down, through a light sensor and
+// LightTask into a jar. Checks that the jar dims with the room, never
+// goes brighter than it's been told, stops altogether in daylight (with
+// every LED off for as long as it's stopped) and doesn't start again
+// until it's properly dark.
+
+#include <chrono>
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace {
+
+struct Stretch {
+    const char* name;
+    uint16_t level;
+};
+
+// Each is held for --seconds, and measured over the second half, once
+// the smoothing has caught up. The last but one sits between resume and
+// pause, so coming from daylight the jar should stay stopped.
+const Stretch DAY[] = {
+    {"night", 10},
+    {"lamp", 300},
+    {"bright lamp", 700},
+    {"daylight", 1000},
+    {"overcast", 850},
+    {"dusk", 400},
+    {"night", 10},
+};
+
+}
+
+
+namespace sim {
+
+int light(const Options& options) {
+    const size_t N = 50;
+    const uint32_t TICK = 1000;
+    // Like curves::desk, but still getting brighter past the pause, so
+    // the jar is handed new brightnesses while it's stopped.
+    const firefly::LightCurve curve = {50, 1000, 900, 800, 48};
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    firefly::Jar<N> jar(sink, clock, rng);
+    firefly::FixedLight sensor(DAY[0].level);
+    firefly::LightTask<firefly::Jar<N>> task(sensor, jar, curve);
+
+    jar.begin();
+
+    unsigned failures = 0;
+    bool paused = false;
+    uint64_t length = (uint64_t)(options.seconds * 1e6);
+
+    std::printf("%-12s %6s %8s %6s %6s %8s %8s %6s %10s %s\n",
+                "", "light", "smoothed", "scale", "paused", "flashes", "peak", "lit", "us/update", "");
+    for (const Stretch& stretch : DAY) {
+        sensor.set(stretch.level);
+
+        unsigned long flashes = 0;
+        unsigned long lit = 0;
+        uint8_t peak = 0;
+        double spent = 0;
+        std::vector<firefly::Phase> phase(N);
+        for (size_t i = 0; i < N; i++) {
+            phase[i] = jar[i].get_phase();
+        }
+
+        for (uint64_t t = 0; t < length; t += TICK) {
+            clock.advance(TICK);
+            task.run(clock.micros());
+
+            auto start = std::chrono::steady_clock::now();
+            jar.update();
+            spent += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+
+            bool settled = t >= length / 2;
+            bool dark = true;
+            for (size_t i = 0; i < N; i++) {
+                firefly::Phase now = jar[i].get_phase();
+                flashes += settled && now == firefly::Phase::rising && phase[i] != now
+                        && !jar.is_paused();
+                phase[i] = now;
+                uint8_t green = (sink.pixels[i] >> 8) & 0xFF;
+                peak = settled && green > peak ? green : peak;
+                dark = dark && sink.pixels[i] == 0;
+            }
+            // Not just once it's settled: a paused jar is dark from the
+            // frame it pauses in.
+            lit += jar.is_paused() && !dark;
+        }
+
+        // The jar should be where the curve (with its hysteresis) puts
+        // the light level.
+        if (stretch.level >= curve.pause) {
+            paused = true;
+        } else if (stretch.level <= curve.resume) {
+            paused = false;
+        }
+        uint8_t scale = curve.brightness(stretch.level);
+        uint8_t limit = paused ? 0 : firefly::species::p_pyralis.color(scale) >> 8 & 0xFF;
+
+        bool ok = jar.is_paused() == paused && jar.get_brightness() == scale
+               && peak <= limit && (paused ? flashes == 0 : flashes > 0) && lit == 0;
+        failures += !ok;
+
+        std::printf("%-12s %6u %8u %6u %6s %8lu %8u %6lu %10.2f %s\n",
+                    stretch.name, stretch.level, task.get_level(), jar.get_brightness(),
+                    jar.is_paused() ? "yes" : "no", flashes, peak, lit, spent / (length / TICK),
+                    ok ? "ok" : "WRONG");
+    }
+
+    return failures ? 1 : 0;
+}
+
+}
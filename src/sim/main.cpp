@@ -0,0 +1,159 @@
+/*
+Host side simulator for the firefly jar.
+
+This runs the exact same engine as the ESP8266 does, but with a clock that
+only moves when we tell it to, so a whole evening can go by in a second.
+It's meant for poking at behavior without having to flash the board and
+stare at a jar for ten minutes.
+
+    sim [scenario] [--pixels 10|50|100|1000] [--seconds S] [--seed X] [--seek S] [--render]
+
+Scenarios:
+
+    run   (default) Run the jar and count flashes. With --render, the jar
+          is drawn to the terminal every 100 ms of simulated time, one
+          character per LED. With --seek, the jar first jumps that many
+          seconds ahead (drawing from a CounterRng, so it lands where
+          running would have) and runs --seconds from there.
+    soak  Run for weeks of simulated time (--seconds defaults to 3 weeks),
+          starting just before micros() wraps, and check that every flash
+          stays within its species' timings across every wrap.
+    night Three hours on the P. Pyralis evening timeline, reporting every
+          ten minutes how many fireflies are out, how often they flashed,
+          and how much time the jar spent updating. --seek skips straight
+          to that many seconds into the night.
+    temperature
+          Half an hour at each of a range of temperatures, checking that
+          the measured dark and rise times follow the species' rate curve.
+    light A compressed day of room light, each stretch held for --seconds
+          (default two minutes), checking that the jar dims with the
+          room, stays under the brightness it was given and stops in
+          daylight.
+    envelope
+          Half an hour of 100 fireflies, checking every flash's peak
+          and step delays against the species' distributions.
+    swarm Fireflies flying along a strip of 60, checking that their light
+          is split between LEDs without any going missing and that none
+          of them jump. --render draws the strip.
+    courtship
+          Ten minutes of 40 males and 10 females on an event bus,
+          reporting event throughput and delivery latency, and checking
+          that the females' flashes answer the males'.
+    predator
+          Half an hour of courtship with four Photuris females among the
+          P. Pyralis ones, checking that eaten males stay dark for just
+          as long as they're digested.
+    population
+          Three days of fireflies arriving, going dormant and leaving,
+          checking that nothing gets allocated along the way and the
+          loop takes just as long at the end as at the start.
+    seek  An hour of a jar run a frame at a time, against the same jar
+          sought straight to every ten minute mark, checking that they
+          agree and how much quicker seeking is.
+    startup
+          The first minute of 1000 fireflies, checking that flashes start
+          as often in the first seconds as they do later on, and that
+          the first frame has as many lit.
+    checkpoint
+          Fifty minutes of a forty minute day, against jars restored from
+          checkpoints: one saved mid-evening, and one saved to sleep
+          through the quiet hours, checking that both carry on exactly.
+*/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "sim.hpp"
+
+namespace sim {
+
+void render(const MemorySink& sink, uint64_t now) {
+    static const char RAMP[] = " .:-=+*#%@";
+    std::printf("%9.3f |", now / 1e6);
+    for (uint32_t rgb : sink.pixels) {
+        // Green is the brightest channel for every species we have.
+        uint8_t level = (rgb >> 8) & 0xFF;
+        std::putchar(RAMP[level * (sizeof(RAMP) - 2) / 255]);
+    }
+    std::printf("|\n");
+}
+
+}
+
+
+namespace {
+
+struct Scenario {
+    const char* name;
+    int (*function)(const sim::Options&);
+    // Simulated seconds, unless --seconds says otherwise.
+    double seconds;
+};
+
+const Scenario SCENARIOS[] = {
+    {"run", sim::run, 60},
+    {"soak", sim::soak, 21 * 24 * 3600.0},
+    {"night", sim::night, 3 * 3600.0},
+    {"temperature", sim::temperature, 1800},
+    {"light", sim::light, 120},
+    {"envelope", sim::envelope, 1800},
+    {"swarm", sim::swarm, 600},
+    {"courtship", sim::courtship, 600},
+    {"predator", sim::predator, 1800},
+    {"population", sim::population, 3 * 24 * 3600.0},
+    {"seek", sim::seek, 3600},
+    {"startup", sim::startup, 60},
+    {"checkpoint", sim::checkpoint, 3000},
+};
+
+
+int usage(const char* name) {
+    std::fprintf(stderr, "usage: %s [run|soak|night|temperature|light|envelope|swarm|courtship|predator|population|seek|startup|checkpoint] [--pixels 10|50|100|1000] [--seconds S] [--seed X] [--seek S] [--render]\n", name);
+    return 2;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+    sim::Options options;
+    const Scenario* scenario = &SCENARIOS[0];
+    bool seconds_given = false;
+
+    int i = 1;
+    if (i < argc && argv[i][0] != '-') {
+        scenario = nullptr;
+        for (const Scenario& s : SCENARIOS) {
+            if (!std::strcmp(argv[i], s.name)) {
+                scenario = &s;
+            }
+        }
+        if (!scenario) {
+            return usage(argv[0]);
+        }
+        i++;
+    }
+
+    for (; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--pixels") && i + 1 < argc) {
+            options.count = std::atoi(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--seconds") && i + 1 < argc) {
+            options.seconds = std::atof(argv[++i]);
+            seconds_given = true;
+        } else if (!std::strcmp(argv[i], "--seed") && i + 1 < argc) {
+            options.seed = std::strtoul(argv[++i], nullptr, 0);
+        } else if (!std::strcmp(argv[i], "--seek") && i + 1 < argc) {
+            options.seek = std::atof(argv[++i]);
+        } else if (!std::strcmp(argv[i], "--render")) {
+            options.draw = true;
+        } else {
+            return usage(argv[0]);
+        }
+    }
+
+    if (!seconds_given) {
+        options.seconds = scenario->seconds;
+    }
+    return scenario->function(options);
+}
@@ -0,0 +1,73 @@
+// One evening on the default timeline: how many fireflies are out, how
+// often they flash, and how much work the jar is doing as the night goes.
+
+#include <chrono>
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace sim {
+
+int night(const Options& options) {
+    const size_t N = 50;
+    const uint32_t TICK = 1000;
+    // Report every ten simulated minutes.
+    const uint64_t BUCKET = 600ull * 1000000;
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng xorshift(options.seed);
+    firefly::CounterRng counter(options.seed);
+    firefly::Rng& rng = options.seek ? (firefly::Rng&)counter : xorshift;
+    static firefly::Jar<N> jar(sink, clock, rng);
+    static const firefly::Timeline timeline(firefly::timelines::p_pyralis_evening);
+
+    jar.begin();
+    jar.set_timeline(timeline, 0);
+    // Seeking lands on a whole frame, so the buckets still line up.
+    uint64_t from = (uint64_t)(options.seek * 1e6) / TICK * TICK;
+    sim::seek(clock, jar, from);
+
+    std::printf("%8s %8s %6s %10s %14s %12s\n",
+                "minute", "activity", "out", "flashes", "updates/frame", "cpu ns/frame");
+
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    std::vector<firefly::Phase> last(N, firefly::Phase::rising);
+    unsigned long flashes = 0;
+    unsigned long long updates = 0;
+    double cpu = 0;
+    unsigned long frames = 0;
+
+    for (uint64_t t = from; t < end; t += TICK) {
+        clock.advance(TICK);
+
+        // The work the jar does is what's being measured, so only
+        // time the update itself.
+        auto start = std::chrono::steady_clock::now();
+        jar.update();
+        cpu += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        updates += jar.get_active();
+        frames++;
+
+        for (size_t i = 0; i < N; i++) {
+            firefly::Phase phase = jar[i].get_phase();
+            if (phase == firefly::Phase::rising && last[i] == firefly::Phase::dark && jar.is_active(i)) {
+                flashes++;
+            }
+            last[i] = phase;
+        }
+
+        if ((t + TICK) % BUCKET == 0) {
+            std::printf("%8llu %8u %6u %10lu %14.1f %12.1f\n",
+                        (unsigned long long)((t + TICK) / 60000000), jar.get_activity(), jar.get_active(),
+                        flashes, (double)updates / frames, cpu / frames);
+            flashes = 0;
+            updates = 0;
+            cpu = 0;
+            frames = 0;
+        }
+    }
+    return 0;
+}
+
+}
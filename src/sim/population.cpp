@@ -0,0 +1,139 @@
+// Days of fireflies arriving, going dormant and leaving. Reports every
+// six hours how many are out, dormant and gone, and checks that all the
+// coming and going doesn't allocate anything, and that the jar's loop
+// only ever walks the fireflies that are out.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "sim.hpp"
+
+namespace {
+
+// Where the operator new below counts allocations, while a Counting is
+// around on this thread. The rest of the time (and on every other
+// thread, for every other scenario) nothing is counted.
+thread_local unsigned long* counter = nullptr;
+
+/*!
+    @brief Count this thread's allocations into `count` for as long as
+           it's in scope.
+*/
+struct Counting {
+    explicit Counting(unsigned long& count) { counter = &count; }
+    ~Counting() { counter = nullptr; }
+};
+
+}
+
+// The simulator's operator new has to be replaced to see allocations at
+// all, but apart from counting while a Counting is in scope it does just
+// what the standard one does.
+void* operator new(std::size_t size) {
+    if (counter) {
+        (*counter)++;
+    }
+    for (;;) {
+        if (void* p = std::malloc(size ? size : 1)) {
+            return p;
+        }
+        std::new_handler handler = std::get_new_handler();
+        if (!handler) {
+            throw std::bad_alloc();
+        }
+        handler();
+    }
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+
+namespace sim {
+
+int population(const Options& options) {
+    const size_t N = 100;
+    const uint16_t INITIAL = 30;
+    // Frames are further apart than on the jar, so that days go by in
+    // seconds, like the soak.
+    const uint32_t TICK = 20000;
+    const uint64_t REPORT = 6 * 3600 * 1000000ull;
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    firefly::Jar<N> jar(sink, clock, rng);
+    firefly::Population<firefly::Jar<N>> population(jar, clock, rng, INITIAL);
+
+    jar.begin();
+    population.begin();
+
+    std::vector<double> periods;
+    periods.reserve(1024);
+    double spent = 0;
+    unsigned long frames = 0;
+    // Frames times fireflies out, since how many are out wanders and
+    // the loop time with it.
+    double work = 0;
+    unsigned long allocations = 0;
+    unsigned long before = allocations;
+    unsigned long leaked = 0;
+    // Frames where the jar's loop walked over anyone but the fireflies
+    // out, which is what keeps its cost following the population.
+    unsigned long strayed = 0;
+
+    std::printf("%8s %5s %8s %6s %9s %10s %10s %8s %s\n",
+                "hours", "out", "dormant", "gone", "arrived", "departed", "us/frame", "ns/out", "allocs");
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    for (uint64_t t = TICK; t <= end; t += TICK) {
+        clock.advance(TICK);
+
+        auto start = std::chrono::steady_clock::now();
+        {
+            Counting counting(allocations);
+            jar.update();
+            population.run(clock.micros());
+        }
+        spent += std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+        frames++;
+        work += jar.get_active();
+        strayed += jar.get_active() != population.get_out();
+
+        if (t % REPORT == 0) {
+            unsigned long allocated = allocations - before;
+            leaked += allocated;
+            periods.push_back(spent * 1000 / work);
+            std::printf("%8.0f %5u %8u %6u %9lu %10lu %10.3f %8.2f %lu\n", t / 3.6e9,
+                        population.get_out(), population.get_dormant(), population.get_absent(),
+                        (unsigned long)population.get_arrivals(), (unsigned long)population.get_departures(),
+                        spent / frames, spent * 1000 / work, allocated);
+            spent = 0;
+            frames = 0;
+            work = 0;
+            before = allocations;
+        }
+    }
+
+    // The loop time per firefly out is only reported: it wanders too
+    // much from run to run to go by. Whether the loop stays in step with
+    // the population is checked by strayed instead.
+    double quickest = 1e300, slowest = 0;
+    for (double p : periods) {
+        quickest = p < quickest ? p : quickest;
+        slowest = p > slowest ? p : slowest;
+    }
+    bool churned = population.get_arrivals() > 0 && population.get_departures() > 0;
+    bool counted = population.get_out() + population.get_dormant() + population.get_absent() == N
+                && jar.get_held() == population.get_dormant() + population.get_absent();
+
+    std::printf("%lu allocations while running, %lu frames the jar's loop didn't match who's out,"
+                " loop time %.1f-%.1f ns per firefly out\n",
+                leaked, strayed, quickest, slowest);
+    bool ok = !leaked && !strayed && churned && counted;
+    std::printf("%s\n", ok ? "ok" : "WRONG");
+    return ok ? 0 : 1;
+}
+
+}
@@ -0,0 +1,97 @@
+// P. Pyralis courting with Photuris females hidden among them. Checks
+// that males do get eaten, that an eaten male stays dark for as long as
+// he's held and no longer, that the predators flash their own (longer)
+// flashes rather than P. Pyralis', and reports how the number of males out
+// changes as they do.
+
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace sim {
+
+int predator(const Options& options) {
+    const size_t N = 50;
+    const uint16_t FEMALES = 10;
+    const uint16_t PREDATORS = 4;
+    const uint32_t TICK = 1000;
+    const uint32_t DIGEST_MS = 60000;
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    firefly::Jar<N> jar(sink, clock, rng);
+    firefly::EventBus bus(clock);
+    firefly::Predator<firefly::Jar<N>> predators(jar, bus, clock, rng, PREDATORS, 10, DIGEST_MS);
+
+    jar.set_courtship(bus, FEMALES);
+    jar.begin();
+    predators.begin();
+
+    std::vector<uint64_t> held_since(N, 0);
+    std::vector<bool> held(N, false);
+    unsigned long lit = 0, early = 0, late = 0;
+    uint16_t most_held = 0;
+    // Only their timings since becoming predators count, not the ones
+    // they started the night with.
+    uint16_t shortest_rise = UINT16_MAX;
+    std::vector<uint32_t> rolls(PREDATORS);
+    for (size_t i = 0; i < PREDATORS; i++) {
+        rolls[i] = jar[i].get_rolls();
+    }
+
+    std::printf("%8s %6s %6s %6s %6s\n", "time s", "males", "held", "lures", "eaten");
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    for (uint64_t t = 0; t < end; t += TICK) {
+        clock.advance(TICK);
+        bus.dispatch(clock.now());
+        jar.update();
+        predators.run(clock.micros());
+
+        for (size_t i = 0; i < N; i++) {
+            bool now = jar.is_held(i);
+            if (now && !held[i]) {
+                held_since[i] = t;
+            } else if (!now && held[i]) {
+                // Released within a frame of being fully digested.
+                uint64_t length = t - held_since[i];
+                early += length < DIGEST_MS * 1000ull;
+                late += length > DIGEST_MS * 1000ull + TICK;
+            }
+            held[i] = now;
+            lit += now && sink.pixels[i] != 0;
+        }
+        most_held = jar.get_held() > most_held ? jar.get_held() : most_held;
+        for (size_t i = 0; i < PREDATORS; i++) {
+            if (jar[i].get_rolls() != rolls[i]) {
+                uint16_t rise = jar[i].get_rising_delay();
+                shortest_rise = rise < shortest_rise ? rise : shortest_rise;
+            }
+        }
+
+        if (t % 60000000 == 0) {
+            uint16_t males = 0;
+            for (size_t i = FEMALES; i < N; i++) {
+                males += jar.is_active(i);
+            }
+            std::printf("%8.0f %6u %6u %6lu %6lu\n", t / 1e6, males, jar.get_held(),
+                        (unsigned long)predators.get_lures(), (unsigned long)predators.get_eaten());
+        }
+    }
+
+    std::printf("%lu males eaten from %lu lures, at most %u held at once,"
+                " %lu released early, %lu late, %lu frames a held LED was lit,"
+                " shortest predator rise %u us\n",
+                (unsigned long)predators.get_eaten(), (unsigned long)predators.get_lures(),
+                most_held, early, late, lit, shortest_rise);
+    // The shortest a Photuris rise can be; a P. Pyralis one can be
+    // well under that.
+    const firefly::Species& photuris = firefly::species::photuris;
+    uint16_t shortest = photuris.rise_min_us * photuris.length_min_pct / 100;
+    bool ok = predators.get_eaten() > 0 && most_held <= FIREFLY_MAX_CATCHES
+           && !early && !late && !lit && shortest_rise >= shortest;
+    std::printf("%s\n", ok ? "ok" : "WRONG");
+    return ok ? 0 : 1;
+}
+
+}
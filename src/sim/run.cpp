@@ -0,0 +1,73 @@
+// Run the jar for a while and count the flashes.
+
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace {
+
+template <size_t N>
+int simulate(const sim::Options& options) {
+    sim::MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng xorshift(options.seed);
+    firefly::CounterRng counter(options.seed);
+    // Seeking only lands where running would have with keyed draws.
+    firefly::Rng& rng = options.seek ? (firefly::Rng&)counter : xorshift;
+    static firefly::Jar<N> jar(sink, clock, rng);
+
+    jar.begin();
+    uint64_t start = (uint64_t)(options.seek * 1e6);
+    sim::seek(clock, jar, start);
+
+    // Step in 1 ms ticks, which is about as often as the ESP8266
+    // gets around its loop when it has other things to do.
+    const uint32_t TICK = 1000;
+    uint64_t end = start + (uint64_t)(options.seconds * 1e6);
+    std::vector<unsigned long> flashes(N, 0);
+    std::vector<firefly::Phase> last(N, firefly::Phase::rising);
+
+    for (uint64_t t = start; t < end; t += TICK) {
+        clock.advance(TICK);
+        jar.update();
+
+        for (size_t i = 0; i < N; i++) {
+            firefly::Phase phase = jar[i].get_phase();
+            if (phase == firefly::Phase::rising && last[i] == firefly::Phase::dark) {
+                flashes[i]++;
+            }
+            last[i] = phase;
+        }
+
+        if (options.draw && t % 100000 == 0) {
+            sim::render(sink, t);
+        }
+    }
+
+    unsigned long total = 0;
+    for (unsigned long n : flashes) {
+        total += n;
+    }
+    std::printf("%zu fireflies, %.0f s simulated, %lu flashes (%.2f per firefly per minute), %lu shows\n",
+                N, options.seconds, total, total * 60.0 / options.seconds / N, sink.shows);
+    return 0;
+}
+
+}
+
+
+namespace sim {
+
+int run(const Options& options) {
+    // Jars are sized at compile time, so only a few sizes are on offer.
+    switch (options.count) {
+        case 10: return simulate<10>(options);
+        case 50: return simulate<50>(options);
+        case 100: return simulate<100>(options);
+        case 1000: return simulate<1000>(options);
+    }
+    std::fprintf(stderr, "--pixels must be one of 10, 50, 100 or 1000\n");
+    return 2;
+}
+
+}
@@ -0,0 +1,82 @@
+// Seeking: a jar stepped a frame at a time, against the same jar sought
+// straight to each ten minute mark, checking that every firefly (and LED)
+// ends up the same either way, and how much quicker seeking is.
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+
+#include "sim.hpp"
+
+namespace {
+
+const size_t N = 50;
+
+using Clock = std::chrono::steady_clock;
+
+double ms_since(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+}
+
+
+namespace sim {
+
+int seek(const Options& options) {
+    const uint32_t TICK = 1000;
+    const uint64_t MARK = 600ull * 1000000;
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::CounterRng rng(options.seed);
+    auto stepped = std::make_unique<firefly::Jar<N>>(sink, clock, rng);
+    stepped->begin();
+
+    std::printf("%8s %12s %12s %10s\n", "minute", "stepping ms", "seeking ms", "different");
+
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    unsigned long different = 0;
+    double stepping = 0;
+
+    for (uint64_t t = 0; t < end; t += TICK) {
+        auto start = Clock::now();
+        clock.advance(TICK);
+        stepped->update();
+        stepping += ms_since(start);
+
+        if ((t + TICK) % MARK != 0) {
+            continue;
+        }
+
+        // A fresh jar with the same seed, taken straight there.
+        MemorySink seek_sink(N);
+        firefly::ManualClock seek_clock;
+        firefly::CounterRng seek_rng(options.seed);
+        auto sought = std::make_unique<firefly::Jar<N>>(seek_sink, seek_clock, seek_rng);
+        sought->begin();
+        start = Clock::now();
+        sim::seek(seek_clock, *sought, t + TICK);
+        double seeking = ms_since(start);
+
+        unsigned long wrong = 0;
+        for (size_t i = 0; i < N; i++) {
+            const firefly::Firefly& a = (*stepped)[i];
+            const firefly::Firefly& b = (*sought)[i];
+            if (a.get_phase() != b.get_phase() || a.get_brightness() != b.get_brightness()
+                || a.get_peak() != b.get_peak() || a.is_visible() != b.is_visible()
+                || sink.pixels[i] != seek_sink.pixels[i]) {
+                wrong++;
+            }
+        }
+        different += wrong;
+
+        std::printf("%8llu %12.1f %12.3f %10lu\n",
+                    (unsigned long long)((t + TICK) / 60000000), stepping, seeking, wrong);
+    }
+
+    std::printf("%lu fireflies ended up different\n", different);
+    return different ? 1 : 0;
+}
+
+}
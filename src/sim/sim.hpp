@@ -0,0 +1,83 @@
+#pragma once
+
+// Pieces shared by the simulator's scenarios.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include <firefly.hpp>
+
+namespace sim {
+
+/*!
+    @brief What to simulate, from the command line.
+*/
+struct Options {
+    size_t count = 10;
+    double seconds = 60;
+    uint32_t seed = 1;
+    bool draw = false;
+    // Seconds to seek ahead before starting, for scenarios that can.
+    double seek = 0;
+};
+
+
+/*!
+    @brief Output that just remembers what the LEDs were told to show.
+*/
+class MemorySink : public firefly::OutputSink {
+  public:
+    std::vector<uint32_t> pixels;
+    unsigned long shows = 0;
+
+    explicit MemorySink(size_t count) : pixels(count, 0) {}
+
+    void set_pixel(uint16_t index, uint32_t rgb) override {
+        if (index < this->pixels.size()) {
+            this->pixels[index] = rgb;
+        }
+    }
+
+    void show() override { this->shows++; }
+};
+
+
+/*!
+    @brief Move the clock on and seek a jar there. Clock::now() has to
+           see the counter at least once every time it wraps, so long
+           seeks are taken half an hour at a time.
+*/
+template <typename J>
+void seek(firefly::ManualClock& clock, J& jar, uint64_t micros) {
+    const uint32_t PIECE = 1800u * 1000000;
+    while (micros) {
+        uint32_t step = micros < PIECE ? micros : PIECE;
+        clock.advance(step);
+        jar.seek();
+        micros -= step;
+    }
+}
+
+
+/*!
+    @brief Draw one line of the jar, darker characters for dimmer LEDs.
+*/
+void render(const MemorySink& sink, uint64_t now);
+
+// The scenarios. Each returns the process exit code.
+int run(const Options& options);
+int soak(const Options& options);
+int night(const Options& options);
+int temperature(const Options& options);
+int light(const Options& options);
+int envelope(const Options& options);
+int swarm(const Options& options);
+int courtship(const Options& options);
+int predator(const Options& options);
+int population(const Options& options);
+int seek(const Options& options);
+int startup(const Options& options);
+int checkpoint(const Options& options);
+
+}
@@ -0,0 +1,140 @@
+// Weeks of simulated time, straight through a few hundred wraps of the
+// 32 bit micros() counter, checking that no flash ever comes out wrong.
+
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace {
+
+// Frames are further apart than on the jar, so that weeks go by in
+// seconds. Every timing check allows for one frame either way.
+const uint32_t TICK = 5000;
+
+// Where the raw counter starts: a few seconds before it wraps.
+const uint32_t START = 0xFFFFFFFFu - 5000000;
+
+
+/*!
+    @brief What we know about one firefly's current phase.
+*/
+struct Track {
+    firefly::Phase phase;
+    uint64_t entered;
+    uint8_t brightness;
+    bool seen;
+};
+
+
+bool within(uint64_t length, uint64_t min, uint64_t max) {
+    return length + TICK >= min && length <= max + TICK;
+}
+
+
+/*!
+    @brief Shortest and longest a rise or fall can be, given the range
+           of its step delay: the fewest steps at the shortest delay and
+           length, or the most at the longest.
+*/
+uint64_t shortest(const firefly::Species& species, uint16_t delay_min) {
+    return (uint64_t)species.peak_min * (delay_min * species.length_min_pct / 100);
+}
+
+uint64_t longest(const firefly::Species& species, uint16_t delay_max) {
+    return (uint64_t)(species.peak_max - 1) * ((delay_max - 1) * (species.length_max_pct - 1) / 100);
+}
+
+}
+
+
+namespace sim {
+
+int soak(const Options& options) {
+    const size_t N = 10;
+    const firefly::Species& species = firefly::species::p_pyralis;
+
+    MemorySink sink(N);
+    firefly::ManualClock clock(START);
+    firefly::XorShiftRng rng(options.seed);
+    static firefly::Jar<N> jar(sink, clock, rng);
+
+    jar.begin();
+
+    // Fireflies start part way through a phase, so the first one each
+    // of them sees through isn't a whole one.
+    jar.update();
+    std::vector<Track> tracks;
+    for (size_t i = 0; i < N; i++) {
+        tracks.push_back(Track{jar[i].get_phase(), 0, jar[i].get_brightness(), false});
+    }
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    unsigned long phases = 0;
+    unsigned long glitches = 0;
+    unsigned long wraps = 0;
+    uint32_t previous_raw = START;
+
+    for (uint64_t t = 0; t < end; t += TICK) {
+        clock.advance(TICK);
+        if (clock.micros() < previous_raw) {
+            wraps++;
+        }
+        previous_raw = clock.micros();
+        jar.update();
+
+        for (size_t i = 0; i < N; i++) {
+            const firefly::Firefly& firefly = jar[i];
+            Track& track = tracks[i];
+            uint8_t brightness = firefly.get_brightness();
+
+            if (firefly.get_phase() == track.phase) {
+                // Within a phase, brightness only ever goes one way.
+                bool wrong = (track.phase == firefly::Phase::rising && brightness < track.brightness)
+                          || (track.phase == firefly::Phase::falling && brightness > track.brightness)
+                          || (track.phase == firefly::Phase::dark && brightness != 0);
+                if (wrong) {
+                    glitches++;
+                    std::printf("firefly %zu: brightness went %u -> %u at %.3f s\n",
+                                i, track.brightness, brightness, t / 1e6);
+                }
+                track.brightness = brightness;
+                continue;
+            }
+
+            // The phase changed, so check how long the last one lasted.
+            uint64_t length = t - track.entered;
+            bool ok = true;
+            if (track.seen) {
+                switch (track.phase) {
+                    case firefly::Phase::dark:
+                        ok = within(length, species.dark_min_ms * 1000ull, species.dark_max_ms * 1000ull);
+                        break;
+                    case firefly::Phase::rising:
+                        ok = within(length, shortest(species, species.rise_min_us),
+                                    longest(species, species.rise_max_us));
+                        break;
+                    case firefly::Phase::falling:
+                        ok = within(length, shortest(species, species.fall_min_us),
+                                    longest(species, species.fall_max_us));
+                        break;
+                }
+                phases++;
+            }
+            if (!ok) {
+                glitches++;
+                std::printf("firefly %zu: phase %d lasted %llu us at %.3f s\n",
+                            i, (int)track.phase, (unsigned long long)length, t / 1e6);
+            }
+
+            track.phase = firefly.get_phase();
+            track.entered = t;
+            track.brightness = brightness;
+            track.seen = true;
+        }
+    }
+
+    std::printf("%.1f days simulated, %lu wraps of micros(), %lu phases checked, %lu glitches\n",
+                options.seconds / 86400, wraps, phases, glitches);
+    return glitches ? 1 : 0;
+}
+
+}
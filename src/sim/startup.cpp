@@ -0,0 +1,112 @@
+// The first seconds of a jar: how many flashes start each second, and how
+// many fireflies are lit, checked against the same jar long after. Next
+// to it, as many fireflies started all at once the way they used to be,
+// to show the rush of flashes the warm start does away with.
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+#include "sim.hpp"
+
+namespace {
+
+const size_t N = 1000;
+
+unsigned lit(const std::vector<const firefly::Firefly*>& fireflies) {
+    unsigned count = 0;
+    for (const firefly::Firefly* firefly : fireflies) {
+        count += firefly->get_brightness() > 0;
+    }
+    return count;
+}
+
+}
+
+
+namespace sim {
+
+int startup(const Options& options) {
+    const uint32_t TICK = 1000;
+    const firefly::Timing timing = firefly::Timing::of(firefly::species::p_pyralis);
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    static firefly::Jar<N> jar(sink, clock, rng);
+    jar.begin();
+
+    firefly::XorShiftRng cold_rng(options.seed);
+    std::vector<firefly::Firefly> cold;
+    for (size_t i = 0; i < N; i++) {
+        cold.emplace_back(i, firefly::species::p_pyralis);
+        cold.back().begin(0, cold_rng, timing);
+    }
+
+    std::vector<const firefly::Firefly*> warm, started;
+    for (size_t i = 0; i < N; i++) {
+        warm.push_back(&jar[i]);
+        started.push_back(&cold[i]);
+    }
+
+    size_t seconds = options.seconds;
+    std::vector<unsigned> warm_starts(seconds, 0), cold_starts(seconds, 0);
+    std::vector<firefly::Phase> warm_last(N), cold_last(N);
+    // Every one of the old way's fireflies starts with a flash.
+    cold_starts[0] = N;
+    for (size_t i = 0; i < N; i++) {
+        warm_last[i] = jar[i].get_phase();
+        cold_last[i] = firefly::Phase::rising;
+    }
+
+    jar.update();
+    unsigned first_lit = lit(warm);
+    double later_lit = 0;
+    unsigned long later_frames = 0;
+
+    for (uint64_t t = TICK; t < seconds * 1000000ull; t += TICK) {
+        clock.advance(TICK);
+        jar.update();
+        size_t second = t / 1000000;
+        for (size_t i = 0; i < N; i++) {
+            cold[i].update(t, cold_rng, timing);
+            if (jar[i].get_phase() == firefly::Phase::rising && warm_last[i] == firefly::Phase::dark) {
+                warm_starts[second]++;
+            }
+            if (cold[i].get_phase() == firefly::Phase::rising && cold_last[i] == firefly::Phase::dark) {
+                cold_starts[second]++;
+            }
+            warm_last[i] = jar[i].get_phase();
+            cold_last[i] = cold[i].get_phase();
+        }
+        if (second >= seconds / 2) {
+            later_lit += lit(warm);
+            later_frames++;
+        }
+    }
+
+    // The second half is long past any start-up, so it's what the first
+    // seconds should look like. Flashes starting in a second are near
+    // enough Poisson, so its spread is the square root of its mean.
+    double steady = 0;
+    for (size_t s = seconds / 2; s < seconds; s++) {
+        steady += warm_starts[s];
+    }
+    steady /= seconds - seconds / 2;
+    later_lit /= later_frames;
+
+    std::printf("%8s %12s %12s\n", "second", "warm starts", "cold starts");
+    unsigned long bad = 0;
+    for (size_t s = 0; s < 10 && s < seconds; s++) {
+        bool ok = std::fabs(warm_starts[s] - steady) <= 5 * std::sqrt(steady);
+        bad += !ok;
+        std::printf("%8zu %12u %12u %s\n", s, warm_starts[s], cold_starts[s], ok ? "" : "too far from steady");
+    }
+    bool lit_ok = std::fabs(first_lit - later_lit) <= 5 * std::sqrt(later_lit);
+    bad += !lit_ok;
+    std::printf("steady state: %.1f flashes a second, %.1f lit; first frame: %u lit%s\n",
+                steady, later_lit, first_lit, lit_ok ? "" : ", too far from steady");
+    return bad ? 1 : 0;
+}
+
+}
@@ -0,0 +1,79 @@
+// Fireflies flying along a strip. Checks that splitting a firefly's light
+// between LEDs doesn't lose or make up any (beyond rounding), and that no
+// firefly ever jumps more than its speed allows between frames. With
+// --render, draws the strip like the run scenario does.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "sim.hpp"
+
+namespace sim {
+
+int swarm(const Options& options) {
+    const size_t N = 60;
+    const size_t M = 8;
+    const uint32_t TICK = 1000;
+    const uint16_t MAX_SPEED = 1024;
+
+    MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    firefly::Swarm<N, M> swarm(sink, clock, rng, MAX_SPEED);
+
+    swarm.begin();
+
+    std::vector<int32_t> positions(M);
+    for (size_t i = 0; i < M; i++) {
+        positions[i] = swarm.get_position(i);
+    }
+
+    // Fastest a position can change in one frame, in 1/65536ths of an
+    // LED, with a tick of slack since speeds are per 1024 us.
+    const int32_t STEP = (MAX_SPEED * 256 * 1024 / 1000000 + 1) * (TICK / 1024 + 2);
+
+    unsigned long frames = 0, lost = 0, jumps = 0;
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    for (uint64_t t = 0; t < end; t += TICK) {
+        clock.advance(TICK);
+        swarm.update();
+        frames++;
+
+        // Every LED's level is its green channel, which is at full for
+        // P. Pyralis. Where LEDs saturate, light is lost on purpose.
+        long expected = 0, measured = 0;
+        bool saturated = false;
+        for (size_t i = 0; i < M; i++) {
+            if (swarm[i].is_visible()) {
+                expected += swarm[i].get_brightness();
+            }
+            int32_t position = swarm.get_position(i);
+            if (std::abs(position - positions[i]) > STEP && swarm[i].get_phase() != firefly::Phase::dark) {
+                jumps++;
+                std::printf("firefly %zu jumped %.3f LEDs at %.3f s\n",
+                            i, (position - positions[i]) / 65536.0, t / 1e6);
+            }
+            positions[i] = position;
+        }
+        for (uint32_t rgb : sink.pixels) {
+            uint8_t level = (rgb >> 8) & 0xFF;
+            measured += level;
+            saturated |= level == 255;
+        }
+        // Each split loses under one step to rounding on either side.
+        if (!saturated && (measured > expected || measured + 2 * (long)M < expected)) {
+            lost++;
+            std::printf("frame at %.3f s: %ld of %ld light shown\n", t / 1e6, measured, expected);
+        }
+
+        if (options.draw && t % 100000 == 0) {
+            render(sink, t);
+        }
+    }
+
+    std::printf("%zu fireflies over %zu LEDs, %lu frames, %lu with light lost, %lu jumps\n",
+                M, N, frames, lost, jumps);
+    return lost || jumps ? 1 : 0;
+}
+
+}
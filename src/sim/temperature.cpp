@@ -0,0 +1,115 @@
+// Flash timings at a range of temperatures, checked against the species'
+// rate curve: the measured dark and rise times should shrink as it gets
+// warmer, by the amount the curve says.
+
+#include <cmath>
+#include <cstdio>
+
+#include "sim.hpp"
+
+namespace {
+
+/*!
+    @brief Average dark and rise lengths over a run, in microseconds.
+*/
+struct Measured {
+    double dark;
+    double rise;
+};
+
+
+Measured measure(int16_t decicelsius, const sim::Options& options) {
+    const size_t N = 50;
+    const uint32_t TICK = 1000;
+
+    sim::MemorySink sink(N);
+    firefly::ManualClock clock;
+    firefly::XorShiftRng rng(options.seed);
+    firefly::Jar<N> jar(sink, clock, rng);
+    firefly::FixedTemperature thermometer(decicelsius);
+    firefly::TemperatureTask<firefly::Jar<N>> task(thermometer, jar);
+
+    jar.begin();
+
+    std::vector<firefly::Phase> phase(N, firefly::Phase::rising);
+    std::vector<uint64_t> entered(N, 0);
+    std::vector<bool> settled(N, false);
+    double dark = 0, rise = 0;
+    unsigned long darks = 0, rises = 0;
+
+    uint64_t end = (uint64_t)(options.seconds * 1e6);
+    for (uint64_t t = 0; t < end; t += TICK) {
+        clock.advance(TICK);
+        task.run(clock.micros());
+        jar.update();
+
+        for (size_t i = 0; i < N; i++) {
+            firefly::Phase now = jar[i].get_phase();
+            if (now == phase[i]) {
+                continue;
+            }
+            // Only count phases that were rolled after the temperature
+            // was set, which is any that start after the first dark.
+            if (settled[i]) {
+                if (phase[i] == firefly::Phase::dark) {
+                    dark += t - entered[i];
+                    darks++;
+                } else if (phase[i] == firefly::Phase::rising) {
+                    rise += t - entered[i];
+                    rises++;
+                }
+            }
+            if (now == firefly::Phase::dark) {
+                settled[i] = true;
+            }
+            phase[i] = now;
+            entered[i] = t;
+        }
+    }
+
+    return {dark / darks, rise / rises};
+}
+
+}
+
+
+namespace sim {
+
+int temperature(const Options& options) {
+    const firefly::Species& species = firefly::species::p_pyralis;
+    const int16_t TEMPERATURES[] = {150, 200, 240, 280, 320};
+    // Mean of a half open range [min, max) of whole numbers. A rise is
+    // peak steps, each the step delay stretched by the flash's length.
+    auto mean = [](double min, double max) { return (min + max - 1) / 2; };
+    const double DARK = mean(species.dark_min_ms, species.dark_max_ms) * 1000;
+    const double RISE = mean(species.rise_min_us, species.rise_max_us)
+                      * mean(species.length_min_pct, species.length_max_pct) / 100
+                      * mean(species.peak_min, species.peak_max);
+    // Allowed error, relative. Half a percent for sampling, plus a frame
+    // of rounding on either end of each phase.
+    const double TOLERANCE = 0.01;
+
+    unsigned failures = 0;
+    double last_dark = 1e300;
+
+    std::printf("%6s %7s %12s %12s %12s %12s %s\n",
+                "temp C", "scale", "dark ms", "expected", "rise ms", "expected", "");
+    for (int16_t t : TEMPERATURES) {
+        double scale = species.interval_scale(t) / 256.0;
+        Measured m = measure(t, options);
+
+        bool ok = std::fabs(m.dark / (DARK * scale) - 1) < TOLERANCE
+               && std::fabs(m.rise / (RISE * scale) - 1) < TOLERANCE
+               && m.dark < last_dark;
+        failures += !ok;
+        last_dark = m.dark;
+
+        std::printf("%6.1f %7.3f %12.1f %12.1f %12.1f %12.1f %s\n",
+                    t / 10.0, scale, m.dark / 1000, DARK * scale / 1000,
+                    m.rise / 1000, RISE * scale / 1000, ok ? "ok" : "WRONG");
+    }
+
+    return failures ? 1 : 0;
+}
+
+}